@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2002-2021, the original author or authors.
+ *
+ * This software is distributable under the BSD license. See the terms of the
+ * BSD license in the documentation provided with this software.
+ *
+ * https://opensource.org/licenses/BSD-3-Clause
+ */
+package org.jline.benchmarks;
+
+import java.io.IOException;
+import java.util.List;
+import java.util.concurrent.TimeUnit;
+
+import org.jline.terminal.impl.LineDisciplineTerminal;
+import org.jline.utils.AttributedString;
+import org.jline.utils.AttributedStringBuilder;
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Fork;
+import org.openjdk.jmh.annotations.Measurement;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+import org.openjdk.jmh.annotations.TearDown;
+import org.openjdk.jmh.annotations.Warmup;
+
+/**
+ * Parsing, rendering and splitting a 10 MB ANSI log with
+ * {@link AttributedStringBuilder} and {@link AttributedString}.
+ */
+@State(Scope.Thread)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.MILLISECONDS)
+@Warmup(iterations = 2, time = 5)
+@Measurement(iterations = 5, time = 5)
+@Fork(1)
+public class AttributedStringBenchmark {
+
+    private LineDisciplineTerminal terminal;
+    private String log;
+    private AttributedString parsed;
+
+    @Setup
+    public void setup() throws IOException {
+        terminal = Fixtures.terminal(200, 50);
+        log = Fixtures.ansiLog();
+        parsed = AttributedString.fromAnsi(log);
+    }
+
+    @TearDown
+    public void tearDown() throws IOException {
+        terminal.close();
+    }
+
+    @Benchmark
+    public AttributedString fromAnsi() {
+        AttributedStringBuilder sb = new AttributedStringBuilder();
+        sb.appendAnsi(log);
+        return sb.toAttributedString();
+    }
+
+    @Benchmark
+    public String toAnsi() {
+        return parsed.toAnsi(terminal);
+    }
+
+    @Benchmark
+    public List<AttributedString> columnSplitLength() {
+        return parsed.columnSplitLength(200);
+    }
+
+    @Benchmark
+    public int columnLength() {
+        return parsed.columnLength();
+    }
+
+}
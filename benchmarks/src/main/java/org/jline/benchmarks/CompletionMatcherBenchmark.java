@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2002-2021, the original author or authors.
+ *
+ * This software is distributable under the BSD license. See the terms of the
+ * BSD license in the documentation provided with this software.
+ *
+ * https://opensource.org/licenses/BSD-3-Clause
+ */
+package org.jline.benchmarks;
+
+import java.util.ArrayList;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Map;
+import java.util.concurrent.TimeUnit;
+
+import org.jline.reader.Candidate;
+import org.jline.reader.CompletingParsedLine;
+import org.jline.reader.LineReader;
+import org.jline.reader.Parser.ParseContext;
+import org.jline.reader.impl.CandidateIndex;
+import org.jline.reader.impl.CandidateList;
+import org.jline.reader.impl.CompletionMatcherImpl;
+import org.jline.reader.impl.DefaultParser;
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Fork;
+import org.openjdk.jmh.annotations.Measurement;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+import org.openjdk.jmh.annotations.Warmup;
+
+/**
+ * Matching a word against 50k completion candidates with the
+ * {@link CompletionMatcherImpl}, as done on each TAB.
+ */
+@State(Scope.Thread)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.MILLISECONDS)
+@Warmup(iterations = 3, time = 2)
+@Measurement(iterations = 5, time = 2)
+@Fork(1)
+public class CompletionMatcherBenchmark {
+
+    /**
+     * A prefix, a substring and a word with a typo.
+     */
+    @Param({"customer_ord", "invoice", "custmer_orders"})
+    public String word;
+
+    @Param({"false", "true"})
+    public boolean caseInsensitive;
+
+    @Param({"false", "true"})
+    public boolean typo;
+
+    /**
+     * Whether the candidates are handed over as a {@link CandidateIndex}.
+     * With a typo, this compares the full distance computations with
+     * the pruned walk over the index.
+     */
+    @Param({"false", "true"})
+    public boolean indexed;
+
+    private List<Candidate> candidates;
+    private CandidateIndex index;
+    private CompletingParsedLine line;
+    private Map<LineReader.Option, Boolean> options;
+
+    @Setup
+    public void setup() {
+        candidates = new ArrayList<>();
+        for (String name : Fixtures.candidates(Fixtures.CANDIDATES)) {
+            candidates.add(new Candidate(name));
+        }
+        index = new CandidateIndex(candidates);
+        String buffer = "select " + word;
+        line = (CompletingParsedLine) new DefaultParser().parse(buffer, buffer.length(), ParseContext.COMPLETE);
+        options = new HashMap<>();
+        options.put(LineReader.Option.COMPLETE_MATCHER_TYPO, typo);
+    }
+
+    @Benchmark
+    public List<Candidate> matches() {
+        CompletionMatcherImpl matcher = new CompletionMatcherImpl();
+        matcher.compile(options, false, line, caseInsensitive, 2, "original");
+        List<Candidate> list = new CandidateList();
+        if (indexed) {
+            list.addAll(index);
+        } else {
+            list.addAll(candidates);
+        }
+        List<Candidate> result = matcher.matches(list);
+        matcher.getCommonPrefix();
+        return result;
+    }
+
+}
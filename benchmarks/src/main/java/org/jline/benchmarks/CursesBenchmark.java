@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2002-2021, the original author or authors.
+ *
+ * This software is distributable under the BSD license. See the terms of the
+ * BSD license in the documentation provided with this software.
+ *
+ * https://opensource.org/licenses/BSD-3-Clause
+ */
+package org.jline.benchmarks;
+
+import java.util.HashMap;
+import java.util.HashSet;
+import java.util.Map;
+import java.util.concurrent.TimeUnit;
+
+import org.jline.utils.Curses;
+import org.jline.utils.InfoCmp;
+import org.jline.utils.InfoCmp.Capability;
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Fork;
+import org.openjdk.jmh.annotations.Measurement;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+import org.openjdk.jmh.annotations.Warmup;
+
+/**
+ * Compares the {@link Curses#tputs(Appendable, String, Object...)} interpreter
+ * with the compiled {@link Curses.Template} form on xterm-256color capabilities.
+ */
+@State(Scope.Thread)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.NANOSECONDS)
+@Warmup(iterations = 3, time = 1)
+@Measurement(iterations = 5, time = 1)
+@Fork(1)
+public class CursesBenchmark {
+
+    @Param({"cursor_address", "parm_right_cursor", "change_scroll_region", "carriage_return"})
+    public String capability;
+
+    private String source;
+    private Curses.Template template;
+    private final StringBuilder sb = new StringBuilder(64);
+    private int counter;
+
+    @Setup
+    public void setup() {
+        Map<Capability, String> strings = new HashMap<>();
+        InfoCmp.parseInfoCmp(InfoCmp.getLoadedInfoCmp("xterm-256color"),
+                new HashSet<>(), new HashMap<>(), strings);
+        source = strings.get(Capability.valueOf(capability));
+        template = Curses.compile(source);
+    }
+
+    @Benchmark
+    public StringBuilder interpreted() {
+        int n = counter++ & 127;
+        sb.setLength(0);
+        Curses.tputs(sb, source, n, n + 1);
+        return sb;
+    }
+
+    @Benchmark
+    public StringBuilder compiled() {
+        int n = counter++ & 127;
+        sb.setLength(0);
+        template.tputs(sb, n, n + 1);
+        return sb;
+    }
+
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2002-2021, the original author or authors.
+ *
+ * This software is distributable under the BSD license. See the terms of the
+ * BSD license in the documentation provided with this software.
+ *
+ * https://opensource.org/licenses/BSD-3-Clause
+ */
+package org.jline.benchmarks;
+
+import java.io.IOException;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.Random;
+import java.util.concurrent.TimeUnit;
+
+import org.jline.terminal.impl.LineDisciplineTerminal;
+import org.jline.utils.AttributedString;
+import org.jline.utils.CellDisplay;
+import org.jline.utils.Display;
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Fork;
+import org.openjdk.jmh.annotations.Measurement;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+import org.openjdk.jmh.annotations.TearDown;
+import org.openjdk.jmh.annotations.Warmup;
+
+/**
+ * Full screen {@link Display} updates, as done by less or tmux,
+ * while scrolling through a colored log file.
+ * <p>
+ * The session benchmark replays a browsing session in a pager:
+ * a mix of line, half page and page moves in both directions
+ * and a few jumps, with a status line at the bottom of the screen.
+ * </p>
+ */
+@State(Scope.Thread)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.MICROSECONDS)
+@Warmup(iterations = 3, time = 2)
+@Measurement(iterations = 5, time = 2)
+@Fork(1)
+public class DisplayBenchmark {
+
+    @Param({"50", "200"})
+    public int rows;
+
+    @Param({"false", "true"})
+    public boolean cells;
+
+    private static final int COLUMNS = 200;
+
+    private LineDisciplineTerminal terminal;
+    private Display display;
+    private List<AttributedString> lines;
+    private int top;
+    private int[] session;
+    private int step;
+
+    @Setup
+    public void setup() throws IOException {
+        terminal = Fixtures.terminal(COLUMNS, rows);
+        display = cells ? new CellDisplay(terminal) : new Display(terminal, true);
+        display.resize(rows, COLUMNS);
+        lines = new ArrayList<>();
+        for (String line : Fixtures.ansiLines(Fixtures.ansiLog(2 * 1024 * 1024))) {
+            lines.add(AttributedString.fromAnsi(line).columnSubSequence(0, COLUMNS));
+        }
+        top = 0;
+        Random random = new Random(1);
+        session = new int[1024];
+        for (int i = 0; i < session.length; i++) {
+            int move = random.nextInt(100);
+            int delta = move < 60 ? 1 : move < 80 ? rows / 2 : move < 95 ? rows - 1 : rows * 10;
+            session[i] = random.nextInt(4) == 0 ? -delta : delta;
+        }
+        step = 0;
+    }
+
+    @TearDown
+    public void tearDown() throws IOException {
+        terminal.close();
+    }
+
+    private List<AttributedString> frame(int delta) {
+        top += delta;
+        if (top + rows > lines.size()) {
+            top = 0;
+        }
+        // Display keeps and modifies the list
+        return new ArrayList<>(lines.subList(top, top + rows));
+    }
+
+    private List<AttributedString> sessionFrame() {
+        int delta = session[step++ % session.length];
+        top = Math.max(0, Math.min(lines.size() - rows, top + delta));
+        List<AttributedString> frame = new ArrayList<>(lines.subList(top, top + rows - 1));
+        frame.add(new AttributedString("lines " + (top + 1) + "-" + (top + rows - 1) + "/" + lines.size()));
+        return frame;
+    }
+
+    @Benchmark
+    public void scrollLine() {
+        display.update(frame(1), 0);
+    }
+
+    @Benchmark
+    public void scrollHalfPage() {
+        display.update(frame(rows / 2), 0);
+    }
+
+    @Benchmark
+    public void scrollPage() {
+        display.update(frame(rows), 0);
+    }
+
+    @Benchmark
+    public void scrollSession() {
+        display.update(sessionFrame(), 0);
+    }
+
+}
@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2002-2021, the original author or authors.
+ *
+ * This software is distributable under the BSD license. See the terms of the
+ * BSD license in the documentation provided with this software.
+ *
+ * https://opensource.org/licenses/BSD-3-Clause
+ */
+package org.jline.benchmarks;
+
+import java.io.IOException;
+import java.io.OutputStream;
+import java.nio.charset.StandardCharsets;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.Random;
+
+import org.jline.terminal.Size;
+import org.jline.terminal.impl.LineDisciplineTerminal;
+
+/**
+ * Deterministic data sets shared by the benchmarks.
+ */
+final class Fixtures {
+
+    static final int HISTORY_SIZE = 100_000;
+    static final int CANDIDATES = 50_000;
+    static final int ANSI_LOG_SIZE = 10 * 1024 * 1024;
+
+    private static final String[] WORDS = {
+            "select", "from", "where", "insert", "update", "delete", "join", "group", "order", "by",
+            "customer", "orders", "invoice", "account", "payment", "product", "warehouse", "shipment",
+            "git", "mvn", "ls", "cd", "grep", "cat", "ssh", "docker", "kubectl", "tail", "less",
+            "status", "commit", "install", "-la", "--follow", "/var/log/syslog", "~/projects/jline3",
+            "日本語", "中文", "한국어", "naïve", "café"
+    };
+
+    private static final String[] LEVELS = {
+            "\033[32mINFO \033[0m", "\033[33mWARN \033[0m", "\033[1;31mERROR\033[0m", "\033[36mDEBUG\033[0m"
+    };
+
+    private static String cachedAnsiLog;
+
+    private Fixtures() {
+    }
+
+    static Random random() {
+        return new Random(0x6a6c696e65L);
+    }
+
+    static String word(Random random) {
+        return WORDS[random.nextInt(WORDS.length)];
+    }
+
+    /**
+     * Command lines as typed in a shell or a database console.
+     */
+    static List<String> historyLines(int count) {
+        Random random = random();
+        List<String> lines = new ArrayList<>(count);
+        StringBuilder sb = new StringBuilder();
+        for (int i = 0; i < count; i++) {
+            sb.setLength(0);
+            int nb = 1 + random.nextInt(8);
+            for (int j = 0; j < nb; j++) {
+                if (j > 0) {
+                    sb.append(' ');
+                }
+                sb.append(word(random));
+            }
+            if (random.nextInt(4) == 0) {
+                sb.append(' ').append(random.nextInt(10_000));
+            }
+            lines.add(sb.toString());
+        }
+        return lines;
+    }
+
+    /**
+     * Unique table and column like names, in no particular order.
+     */
+    static List<String> candidates(int count) {
+        Random random = random();
+        List<String> names = new ArrayList<>(count);
+        for (int i = 0; i < count; i++) {
+            String name = word(random) + "_" + word(random) + "_" + Integer.toString(i, 36);
+            names.add(random.nextBoolean() ? name : name.toUpperCase());
+        }
+        return names;
+    }
+
+    /**
+     * A log file colored with SGR sequences, about 10 MB large.
+     * The result is cached as it is expensive to build.
+     */
+    static synchronized String ansiLog() {
+        if (cachedAnsiLog == null) {
+            cachedAnsiLog = ansiLog(ANSI_LOG_SIZE);
+        }
+        return cachedAnsiLog;
+    }
+
+    static String ansiLog(int size) {
+        Random random = random();
+        StringBuilder sb = new StringBuilder(size + 256);
+        long time = 1_600_000_000_000L;
+        while (sb.length() < size) {
+            time += random.nextInt(1000);
+            sb.append("\033[2m").append(time).append("\033[0m ");
+            sb.append(LEVELS[random.nextInt(LEVELS.length)]).append(' ');
+            int nb = 4 + random.nextInt(20);
+            for (int j = 0; j < nb; j++) {
+                String w = word(random);
+                if (random.nextInt(8) == 0) {
+                    sb.append("\033[").append(30 + random.nextInt(8)).append('m').append(w).append("\033[39m");
+                } else {
+                    sb.append(w);
+                }
+                sb.append(' ');
+            }
+            sb.append('\n');
+        }
+        return sb.toString();
+    }
+
+    /**
+     * Split the log into lines, keeping the escape sequences.
+     */
+    static List<String> ansiLines(String log) {
+        List<String> lines = new ArrayList<>();
+        int start = 0;
+        int idx;
+        while ((idx = log.indexOf('\n', start)) >= 0) {
+            lines.add(log.substring(start, idx));
+            start = idx + 1;
+        }
+        return lines;
+    }
+
+    /**
+     * An in-memory xterm-256color terminal discarding its output.
+     */
+    static LineDisciplineTerminal terminal(int columns, int rows) throws IOException {
+        LineDisciplineTerminal terminal = new LineDisciplineTerminal("benchmark", "xterm-256color",
+                new NullOutputStream(), StandardCharsets.UTF_8);
+        terminal.setSize(new Size(columns, rows));
+        return terminal;
+    }
+
+    static class NullOutputStream extends OutputStream {
+        long count;
+
+        @Override
+        public void write(int b) {
+            count++;
+        }
+
+        @Override
+        public void write(byte[] b, int off, int len) {
+            count += len;
+        }
+    }
+
+}
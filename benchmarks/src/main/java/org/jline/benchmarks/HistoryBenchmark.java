@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2002-2021, the original author or authors.
+ *
+ * This software is distributable under the BSD license. See the terms of the
+ * BSD license in the documentation provided with this software.
+ *
+ * https://opensource.org/licenses/BSD-3-Clause
+ */
+package org.jline.benchmarks;
+
+import java.io.BufferedWriter;
+import java.io.IOException;
+import java.nio.file.Files;
+import java.nio.file.Path;
+import java.time.Instant;
+import java.util.List;
+import java.util.Random;
+import java.util.concurrent.TimeUnit;
+
+import org.jline.reader.LineReader;
+import org.jline.reader.LineReaderBuilder;
+import org.jline.reader.impl.LineReaderImpl;
+import org.jline.reader.impl.history.DefaultHistory;
+import org.jline.reader.impl.history.IndexedHistory;
+import org.jline.terminal.impl.LineDisciplineTerminal;
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Fork;
+import org.openjdk.jmh.annotations.Level;
+import org.openjdk.jmh.annotations.Measurement;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+import org.openjdk.jmh.annotations.TearDown;
+import org.openjdk.jmh.annotations.Warmup;
+
+/**
+ * {@link DefaultHistory} operations on a 100k entries history.
+ */
+@State(Scope.Thread)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.MICROSECONDS)
+@Warmup(iterations = 3, time = 2)
+@Measurement(iterations = 5, time = 2)
+@Fork(1)
+public class HistoryBenchmark {
+
+    @Param({"default", "indexed"})
+    public String implementation;
+
+    private LineDisciplineTerminal terminal;
+    private LineReaderImpl reader;
+    private DefaultHistory history;
+    private Path file;
+    private List<String> lines;
+    private Random random;
+    private int counter;
+
+    @Setup(Level.Trial)
+    public void setup() throws IOException {
+        lines = Fixtures.historyLines(Fixtures.HISTORY_SIZE);
+        file = Files.createTempFile("jline-history", ".txt");
+        long time = Instant.now().toEpochMilli() - lines.size();
+        try (BufferedWriter writer = Files.newBufferedWriter(file)) {
+            for (String line : lines) {
+                writer.append(Long.toString(time++)).append(':').append(line).append('\n');
+            }
+        }
+        terminal = Fixtures.terminal(200, 50);
+        history = "indexed".equals(implementation) ? new IndexedHistory() : new DefaultHistory();
+        reader = (LineReaderImpl) LineReaderBuilder.builder()
+                .terminal(terminal)
+                .variable(LineReader.HISTORY_FILE, file)
+                .variable(LineReader.HISTORY_SIZE, Fixtures.HISTORY_SIZE)
+                .variable(LineReader.HISTORY_FILE_SIZE, Fixtures.HISTORY_SIZE)
+                // measure the in-memory structures, not the file appends
+                .option(LineReader.Option.HISTORY_INCREMENTAL, false)
+                .history(history)
+                .build();
+        random = Fixtures.random();
+    }
+
+    @TearDown(Level.Trial)
+    public void tearDown() throws IOException {
+        terminal.close();
+        Files.deleteIfExists(file);
+    }
+
+    @Benchmark
+    @OutputTimeUnit(TimeUnit.MILLISECONDS)
+    public DefaultHistory load() throws IOException {
+        history.load();
+        return history;
+    }
+
+    @Benchmark
+    public DefaultHistory add() {
+        // the history is full, so this also evicts the oldest entry
+        history.add(lines.get(counter++ % lines.size()));
+        return history;
+    }
+
+    @Benchmark
+    public String get() {
+        return history.get(history.first() + random.nextInt(history.size()));
+    }
+
+    @Benchmark
+    public boolean moveTo() {
+        return history.moveTo(history.first() + random.nextInt(history.size()));
+    }
+
+    /**
+     * Incremental search for a term present only in the oldest entries.
+     */
+    @Benchmark
+    public int searchBackwards() {
+        return reader.searchBackwards("not-in-history", history.last() + 1, false);
+    }
+
+    @Benchmark
+    public int searchBackwardsPrefix() {
+        return reader.searchBackwards("kubectl status", history.last() + 1, true);
+    }
+
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2002-2021, the original author or authors.
+ *
+ * This software is distributable under the BSD license. See the terms of the
+ * BSD license in the documentation provided with this software.
+ *
+ * https://opensource.org/licenses/BSD-3-Clause
+ */
+package org.jline.benchmarks;
+
+import org.openjdk.jmh.results.format.ResultFormatType;
+import org.openjdk.jmh.runner.Runner;
+import org.openjdk.jmh.runner.options.ChainedOptionsBuilder;
+import org.openjdk.jmh.runner.options.CommandLineOptions;
+import org.openjdk.jmh.runner.options.OptionsBuilder;
+
+/**
+ * Entry point of the benchmarks jar.
+ * <p>
+ * Accepts the usual JMH command line options, but writes the results
+ * as JSON to <code>jmh-result.json</code> unless <code>-rf</code> or
+ * <code>-rff</code> say otherwise, so that runs can be compared between
+ * releases.
+ * </p>
+ */
+public class Main {
+
+    public static final String DEFAULT_RESULT_FILE = "jmh-result.json";
+
+    public static void main(String[] args) throws Exception {
+        CommandLineOptions cmd = new CommandLineOptions(args);
+        if (cmd.shouldHelp() || cmd.shouldList() || cmd.shouldListWithParams()
+                || cmd.shouldListProfilers() || cmd.shouldListResultFormats()) {
+            org.openjdk.jmh.Main.main(args);
+            return;
+        }
+        ChainedOptionsBuilder builder = new OptionsBuilder().parent(cmd);
+        if (!cmd.getResultFormat().hasValue()) {
+            builder.resultFormat(ResultFormatType.JSON);
+        }
+        if (!cmd.getResult().hasValue()) {
+            builder.result(DEFAULT_RESULT_FILE);
+        }
+        new Runner(builder.build()).run();
+    }
+
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2002-2021, the original author or authors.
+ *
+ * This software is distributable under the BSD license. See the terms of the
+ * BSD license in the documentation provided with this software.
+ *
+ * https://opensource.org/licenses/BSD-3-Clause
+ */
+package org.jline.benchmarks;
+
+import java.io.CharArrayReader;
+import java.io.IOException;
+import java.util.Random;
+import java.util.concurrent.TimeUnit;
+
+import org.jline.utils.NonBlocking;
+import org.jline.utils.NonBlockingReader;
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Fork;
+import org.openjdk.jmh.annotations.Measurement;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+import org.openjdk.jmh.annotations.Warmup;
+
+/**
+ * Throughput of a non blocking reader, whose characters are read by its
+ * thread.  Each operation reads one MiB, so the score is in MiB/s.
+ */
+@State(Scope.Thread)
+@BenchmarkMode(Mode.Throughput)
+@OutputTimeUnit(TimeUnit.SECONDS)
+@Warmup(iterations = 2, time = 5)
+@Measurement(iterations = 3, time = 5)
+@Fork(1)
+public class NonBlockingReaderBenchmark {
+
+    private static final int SIZE = 1024 * 1024;
+
+    /**
+     * Whether the characters are drained with readBuffered, or read one at a time.
+     */
+    @Param({"false", "true"})
+    public boolean buffered;
+
+    private char[] input;
+
+    @Setup
+    public void setup() {
+        Random random = new Random(1);
+        input = new char[SIZE];
+        for (int i = 0; i < SIZE; i++) {
+            input[i] = (char) (' ' + random.nextInt(95));
+        }
+    }
+
+    @Benchmark
+    public long read() throws IOException {
+        NonBlockingReader reader = NonBlocking.nonBlocking("benchmark", new CharArrayReader(input));
+        try {
+            char[] buf = new char[1024];
+            long sum = 0;
+            while (true) {
+                // a timeout makes the reader thread read the characters
+                int c = buffered ? reader.peek(1000L) : reader.read(1000L);
+                if (c == NonBlockingReader.EOF) {
+                    return sum;
+                } else if (c == NonBlockingReader.READ_EXPIRED) {
+                    continue;
+                }
+                if (buffered) {
+                    int n = reader.readBuffered(buf);
+                    for (int i = 0; i < n; i++) {
+                        sum += buf[i];
+                    }
+                } else {
+                    sum += c;
+                }
+            }
+        } finally {
+            reader.close();
+        }
+    }
+
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2002-2021, the original author or authors.
+ *
+ * This software is distributable under the BSD license. See the terms of the
+ * BSD license in the documentation provided with this software.
+ *
+ * https://opensource.org/licenses/BSD-3-Clause
+ */
+package org.jline.benchmarks;
+
+import java.io.ByteArrayInputStream;
+import java.io.IOException;
+import java.nio.charset.StandardCharsets;
+import java.util.Random;
+import java.util.concurrent.TimeUnit;
+
+import org.jline.reader.LineReader;
+import org.jline.reader.LineReaderBuilder;
+import org.jline.reader.impl.LineReaderImpl;
+import org.jline.terminal.Size;
+import org.jline.terminal.Terminal;
+import org.jline.terminal.impl.ExternalTerminal;
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Fork;
+import org.openjdk.jmh.annotations.Measurement;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+import org.openjdk.jmh.annotations.Warmup;
+
+/**
+ * Reading a line made of a large paste, with or without bracketed paste.
+ * Without bracketed paste, the characters are inserted in bursts.
+ */
+@State(Scope.Thread)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.MILLISECONDS)
+@Warmup(iterations = 2, time = 5)
+@Measurement(iterations = 3, time = 5)
+@Fork(1)
+public class PasteBenchmark {
+
+    private static final String[] WORDS = { "select", "customer_id,", "sum(amount)", "from", "orders", "where",
+            "status", "=", "'open'", "and", "created_at", ">", "now()", "group", "by", "1;" };
+
+    @Param({"10000", "1000000"})
+    public int size;
+
+    @Param({"false", "true"})
+    public boolean bracketed;
+
+    private byte[] input;
+
+    @Setup
+    public void setup() {
+        Random random = new Random(1);
+        StringBuilder sb = new StringBuilder();
+        if (bracketed) {
+            sb.append(LineReaderImpl.BRACKETED_PASTE_BEGIN);
+        }
+        int start = sb.length();
+        while (sb.length() - start < size) {
+            sb.append(WORDS[random.nextInt(WORDS.length)]).append(' ');
+        }
+        if (bracketed) {
+            sb.append(LineReaderImpl.BRACKETED_PASTE_END);
+        }
+        sb.append('\r');
+        input = sb.toString().getBytes(StandardCharsets.UTF_8);
+    }
+
+    @Benchmark
+    public String paste() throws IOException {
+        try (Terminal terminal = new ExternalTerminal("benchmark", "xterm-256color",
+                new ByteArrayInputStream(input), new Fixtures.NullOutputStream(), StandardCharsets.UTF_8)) {
+            terminal.setSize(new Size(160, 50));
+            LineReader reader = LineReaderBuilder.builder().terminal(terminal).build();
+            return reader.readLine("sql> ");
+        }
+    }
+
+}
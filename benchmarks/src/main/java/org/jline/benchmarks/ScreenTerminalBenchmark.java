@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2002-2021, the original author or authors.
+ *
+ * This software is distributable under the BSD license. See the terms of the
+ * BSD license in the documentation provided with this software.
+ *
+ * https://opensource.org/licenses/BSD-3-Clause
+ */
+package org.jline.benchmarks;
+
+import java.util.concurrent.TimeUnit;
+
+import org.jline.builtins.ScreenTerminal;
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Fork;
+import org.openjdk.jmh.annotations.Measurement;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+import org.openjdk.jmh.annotations.Warmup;
+
+/**
+ * Feeding a 10 MB ANSI log through the {@link ScreenTerminal} emulator
+ * used by tmux, and dumping its screen.
+ */
+@State(Scope.Thread)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.MILLISECONDS)
+@Warmup(iterations = 2, time = 5)
+@Measurement(iterations = 5, time = 5)
+@Fork(1)
+public class ScreenTerminalBenchmark {
+
+    private static final int CHUNK = 4096;
+
+    private String log;
+    private ScreenTerminal screen;
+
+    @Setup
+    public void setup() {
+        log = Fixtures.ansiLog().replace("\n", "\r\n");
+        screen = new ScreenTerminal(200, 50);
+    }
+
+    @Benchmark
+    public ScreenTerminal write() {
+        for (int i = 0; i < log.length(); i += CHUNK) {
+            screen.write(log.subSequence(i, Math.min(log.length(), i + CHUNK)));
+        }
+        return screen;
+    }
+
+    @Benchmark
+    @OutputTimeUnit(TimeUnit.MICROSECONDS)
+    public String dump() throws InterruptedException {
+        return screen.dump(0, true);
+    }
+
+}
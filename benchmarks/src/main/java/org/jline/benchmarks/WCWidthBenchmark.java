@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2002-2021, the original author or authors.
+ *
+ * This software is distributable under the BSD license. See the terms of the
+ * BSD license in the documentation provided with this software.
+ *
+ * https://opensource.org/licenses/BSD-3-Clause
+ */
+package org.jline.benchmarks;
+
+import java.util.concurrent.TimeUnit;
+
+import org.jline.utils.AttributedString;
+import org.jline.utils.WCWidth;
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Fork;
+import org.openjdk.jmh.annotations.Measurement;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+import org.openjdk.jmh.annotations.Warmup;
+
+/**
+ * Column width computation on a 1 MB mixed ASCII / CJK text.
+ */
+@State(Scope.Thread)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.MICROSECONDS)
+@Warmup(iterations = 3, time = 2)
+@Measurement(iterations = 5, time = 2)
+@Fork(1)
+public class WCWidthBenchmark {
+
+    private int[] codePoints;
+
+    @Setup
+    public void setup() {
+        codePoints = AttributedString.stripAnsi(Fixtures.ansiLog(1024 * 1024)).codePoints().toArray();
+    }
+
+    @Benchmark
+    public int wcwidth() {
+        int width = 0;
+        for (int cp : codePoints) {
+            width += WCWidth.wcwidth(cp);
+        }
+        return width;
+    }
+
+}
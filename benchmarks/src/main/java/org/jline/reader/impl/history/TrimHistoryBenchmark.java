@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2002-2021, the original author or authors.
+ *
+ * This software is distributable under the BSD license. See the terms of the
+ * BSD license in the documentation provided with this software.
+ *
+ * https://opensource.org/licenses/BSD-3-Clause
+ */
+package org.jline.reader.impl.history;
+
+import java.time.Instant;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.Random;
+import java.util.concurrent.TimeUnit;
+
+import org.jline.reader.History.Entry;
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Fork;
+import org.openjdk.jmh.annotations.Measurement;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+import org.openjdk.jmh.annotations.Warmup;
+
+/**
+ * Trimming of history files done on save, which should scale
+ * linearly with the number of lines in the file.
+ * This benchmark lives in the history package to access
+ * {@link DefaultHistory#doTrimHistory(List, int)}.
+ */
+@State(Scope.Thread)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.MILLISECONDS)
+@Warmup(iterations = 3, time = 2)
+@Measurement(iterations = 5, time = 2)
+@Fork(1)
+public class TrimHistoryBenchmark {
+
+    @Param({"10000", "100000", "1000000"})
+    public int size;
+
+    private List<Entry> entries;
+
+    @Setup
+    public void setup() {
+        Random random = new Random(0);
+        Instant now = Instant.now();
+        entries = new ArrayList<>(size);
+        for (int i = 0; i < size; i++) {
+            // about one third of duplicates
+            entries.add(new DefaultHistory.EntryImpl(i, now, "command " + random.nextInt(size * 2 / 3)));
+        }
+    }
+
+    @Benchmark
+    public List<Entry> trim() {
+        return DefaultHistory.doTrimHistory(entries, size * 4 / 5);
+    }
+
+}
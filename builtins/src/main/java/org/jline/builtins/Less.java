@@ -143,7 +143,7 @@ public class Less {
 
     public Less(Terminal terminal, Path currentDir, Options opts, ConfigurationPath configPath) {
         this.terminal = terminal;
-        this.display = new Display(terminal, true);
+        this.display = Display.fullScreen(terminal);
         this.bindingReader = new BindingReader(terminal.reader());
         this.currentDir = currentDir;
         Path lessrc = configPath != null ? configPath.getConfig("jlessrc") : null;
@@ -1526,6 +1526,21 @@ public class Nano implements Editor {
             startEndHighlight = false;
         }
 
+        /**
+         * The state at the end of the last highlighted line, from which
+         * the highlighting of the next line can be restarted.
+         *
+         * @return the index of the unterminated start/end rule, or -1
+         */
+        public int getState() {
+            return startEndHighlight ? ruleStartId : -1;
+        }
+
+        public void setState(int state) {
+            startEndHighlight = state >= 0;
+            ruleStartId = Math.max(state, 0);
+        }
+
         public AttributedString highlight(String string) {
             return highlight(new AttributedString(string));
         }
@@ -1943,7 +1958,7 @@ public class Nano implements Editor {
         this.terminal = terminal;
         this.windowsTerminal = terminal.getClass().getSimpleName().endsWith("WinSysTerminal");
         this.root = root;
-        this.display = new Display(terminal, true);
+        this.display = Display.fullScreen(terminal);
         this.bindingReader = new BindingReader(terminal.reader());
         this.size = new Size();
         Attributes attrs = terminal.getAttributes();
@@ -113,7 +113,7 @@ public class TTop {
 
     public TTop(Terminal terminal) {
         this.terminal = terminal;
-        this.display = new Display(terminal, true);
+        this.display = Display.fullScreen(terminal);
         this.bindingReader = new BindingReader(terminal.reader());
 
         DecimalFormatSymbols dfs = new DecimalFormatSymbols();
@@ -379,7 +379,7 @@ public class Tmux {
         this.terminal = terminal;
         this.err = err;
         this.runner = runner;
-        display = new Display(terminal, true);
+        display = Display.fullScreen(terminal);
         // Find terminal to use
         Integer colors = terminal.getNumericCapability(Capability.max_colors);
         term = (colors != null && colors >= 256) ? "screen-256color" : "screen";
@@ -33,6 +33,7 @@ import java.util.*;
  */
 public class SystemHighlighter extends DefaultHighlighter {
     private final static StyleResolver resolver = Styles.lsStyle();
+    private final static Integer LANGUAGE_START = -1;
     protected final SyntaxHighlighter commandHighlighter;
     protected final SyntaxHighlighter argsHighlighter;
     protected final SyntaxHighlighter langHighlighter;
@@ -49,7 +50,33 @@ public class SystemHighlighter extends DefaultHighlighter {
 
     @Override
     public AttributedString highlight(LineReader reader, String buffer) {
-        return doDefaultHighlight(reader) ? super.highlight(reader, buffer) : systemHighlight(reader, buffer);
+        return doDefaultHighlight(reader) || isLanguage(reader, buffer)
+                ? super.highlight(reader, buffer) : systemHighlight(reader, buffer);
+    }
+
+    @Override
+    public AttributedString highlight(LineReader reader, String buffer, int start, int removed, int inserted) {
+        if (doDefaultHighlight(reader) || isLanguage(reader, buffer)) {
+            return super.highlight(reader, buffer, start, removed, inserted);
+        }
+        clearLines();
+        return systemHighlight(reader, buffer);
+    }
+
+    @Override
+    protected Object initialState(LineReader reader, String buffer) {
+        return doDefaultHighlight(reader) ? super.initialState(reader, buffer) : LANGUAGE_START;
+    }
+
+    @Override
+    protected Object highlightLine(LineReader reader, String buffer, int start, int end, Object state
+            , AttributedStringBuilder sb) {
+        if (!(state instanceof Integer)) {
+            return super.highlightLine(reader, buffer, start, end, state, sb);
+        }
+        langHighlighter.setState((Integer) state);
+        sb.append(langHighlighter.highlight(buffer.substring(start, end)));
+        return langHighlighter.getState();
     }
 
     public void addFileHighlight(String... commands) {
@@ -62,6 +89,27 @@ public class SystemHighlighter extends DefaultHighlighter {
         fileHighlight.put(command, new FileHighlightCommand(subcommand, fileOptions));
     }
 
+    /**
+     * Whether the buffer is highlighted line by line using the language highlighter.
+     */
+    private boolean isLanguage(LineReader reader, String buffer) {
+        if (langHighlighter == null) {
+            return false;
+        }
+        // the command is in the first non blank line, avoid parsing the whole buffer
+        int idx = 0;
+        while (idx < buffer.length() && buffer.charAt(idx) <= ' ') {
+            idx++;
+        }
+        if (idx == buffer.length()) {
+            return false;
+        }
+        int eol = buffer.indexOf('\n', idx);
+        String command = reader.getParser().getCommand(eol < 0 ? buffer : buffer.substring(0, eol));
+        return !fileHighlight.containsKey(command)
+                && !systemRegistry.isCommandOrScript(command) && !systemRegistry.isCommandAlias(command);
+    }
+
     private boolean doDefaultHighlight(LineReader reader) {
         String search = reader.getSearchTerm();
         return ((search != null && search.length() > 0) || reader.getRegionActive() != LineReader.RegionType.NONE
@@ -84,7 +132,7 @@ public class SystemHighlighter extends DefaultHighlighter {
         } else if (systemRegistry.isCommandOrScript(command) || systemRegistry.isCommandAlias(command)) {
             out = doCommandHighlight(buffer);
         } else if (langHighlighter != null) {
-            out = langHighlighter.highlight(buffer);
+            out = super.highlight(reader, buffer);
         } else {
             out = new AttributedStringBuilder().append(buffer).toAttributedString();
         }
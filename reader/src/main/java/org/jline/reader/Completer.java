@@ -8,7 +8,9 @@
  */
 package org.jline.reader;
 
+import java.util.ArrayList;
 import java.util.List;
+import java.util.function.Consumer;
 
 /**
  * A completer is the mechanism by which tab-completion candidates will be resolved.
@@ -35,4 +37,34 @@ public interface Completer
      * @param candidates    The {@link List} of candidates to populate
      */
     void complete(LineReader reader, ParsedLine line, List<Candidate> candidates);
+
+    /**
+     * Hands over the possible completions for the <i>command line</i> in batches,
+     * as they are found.
+     *
+     * This method is used when the {@link LineReader.Option#COMPLETE_ASYNC} option
+     * is set.  It is then called on one of a few shared threads, which is interrupted
+     * when the completion is cancelled.  Implementations doing expensive work must
+     * check {@link Thread#isInterrupted()} between batches, and stop blocking
+     * operations when interrupted, and give up early: the batches handed over once
+     * the completion is cancelled are dropped, and a completer which doesn't stop
+     * keeps its thread busy, so that later completions may end up running on the
+     * reading thread.
+     *
+     * The default implementation calls {@link #complete(LineReader, ParsedLine, List)}
+     * and hands over all the candidates in a single batch.  The line reader does
+     * not call it, but calls {@link #complete(LineReader, ParsedLine, List)} itself
+     * with a list keeping track of the indexed candidates added.
+     *
+     * @param reader        The line reader
+     * @param line          The parsed command line
+     * @param batches       The consumer of the batches of candidates
+     */
+    default void completeIncrementally(LineReader reader, ParsedLine line, Consumer<List<Candidate>> batches) {
+        List<Candidate> candidates = new ArrayList<>();
+        complete(reader, line, candidates);
+        if (!candidates.isEmpty()) {
+            batches.accept(candidates);
+        }
+    }
 }
@@ -15,6 +15,36 @@ import org.jline.utils.AttributedString;
 public interface Highlighter {
 
     AttributedString highlight(LineReader reader, String buffer);
+
+    /**
+     * Highlight the buffer after it has been edited.  Compared with the buffer
+     * given to the previous call of this method by the same reader, the
+     * {@code removed} characters at index {@code start} have been replaced
+     * with the {@code inserted} characters now at that index, so that only the
+     * affected part of the buffer needs to be highlighted again.
+     * The default implementation highlights the whole buffer.
+     *
+     * @param reader the line reader
+     * @param buffer the buffer to highlight
+     * @param start the index of the edited region
+     * @param removed the number of characters removed at {@code start}
+     * @param inserted the number of characters inserted at {@code start}
+     * @return the highlighted buffer
+     */
+    default AttributedString highlight(LineReader reader, String buffer, int start, int removed, int inserted) {
+        return highlight(reader, buffer);
+    }
+
+    /**
+     * Whether this highlighter only highlights the edited region of the buffer,
+     * in which case it is used whatever the size of the buffer.
+     *
+     * @return <code>true</code> if the buffer is highlighted incrementally
+     */
+    default boolean isIncremental() {
+        return false;
+    }
+
     public void setErrorPattern(Pattern errorPattern);
     public void setErrorIndex(int errorIndex);
 }
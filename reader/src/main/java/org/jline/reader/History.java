@@ -147,6 +147,60 @@ public interface History extends Iterable<History.Entry>
         };
     }
 
+    //
+    // Search
+    //
+
+    /**
+     * Search backwards in history for an entry containing the given term.
+     *
+     * @param searchTerm the substring to search for
+     * @param startIndex the search starts with the entry before this index
+     * @param startsWith if <code>true</code>, the entry has to start with the search term
+     * @param caseInsensitive if <code>true</code>, the search is case insensitive
+     * @return the index of the matching entry, or -1 if none is found
+     */
+    default int searchBackwards(String searchTerm, int startIndex, boolean startsWith, boolean caseInsensitive) {
+        if (caseInsensitive) {
+            searchTerm = searchTerm.toLowerCase();
+        }
+        ListIterator<Entry> it = iterator(Math.max(first(), Math.min(startIndex, last() + 1)));
+        while (it.hasPrevious()) {
+            Entry e = it.previous();
+            String line = caseInsensitive ? e.line().toLowerCase() : e.line();
+            int idx = line.indexOf(searchTerm);
+            if ((startsWith && idx == 0) || (!startsWith && idx >= 0)) {
+                return e.index();
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * Search forwards in history for an entry containing the given term.
+     *
+     * @param searchTerm the substring to search for
+     * @param startIndex the search starts with the entry at this index
+     * @param startsWith if <code>true</code>, the entry has to start with the search term
+     * @param caseInsensitive if <code>true</code>, the search is case insensitive
+     * @return the index of the matching entry, or -1 if none is found
+     */
+    default int searchForwards(String searchTerm, int startIndex, boolean startsWith, boolean caseInsensitive) {
+        if (caseInsensitive) {
+            searchTerm = searchTerm.toLowerCase();
+        }
+        ListIterator<Entry> it = iterator(Math.max(first(), Math.min(startIndex, last() + 1)));
+        while (it.hasNext()) {
+            Entry e = it.next();
+            String line = caseInsensitive ? e.line().toLowerCase() : e.line();
+            int idx = line.indexOf(searchTerm);
+            if ((startsWith && idx == 0) || (!startsWith && idx >= 0)) {
+                return e.index();
+            }
+        }
+        return -1;
+    }
+
     //
     // Navigation
     //
@@ -379,8 +379,9 @@ public interface LineReader {
     /**
      * Max buffer size for advanced features.
      * Once the length of the buffer reaches this threshold, no
-     * advanced features will be enabled. This includes the undo
-     * buffer, syntax highlighting, parsing, etc....
+     * advanced features will be enabled. This includes syntax
+     * highlighting by highlighters which are not incremental,
+     * parsing, etc....
      */
     String FEATURES_MAX_BUFFER_SIZE = "features-max-buffer-size";
 
@@ -390,10 +391,29 @@ public interface LineReader {
      */
     String SUGGESTIONS_MIN_BUFFER_SIZE = "suggestions-min-buffer-size";
 
+    /**
+     * Time in milliseconds given to the completers run in parallel
+     * by an aggregate completer when {@link Option#COMPLETE_PARALLEL}
+     * is set.  Completers which have not finished by then are dropped.
+     */
+    String COMPLETER_TIMEOUT = "completer-timeout";
+
+    /**
+     * Time in milliseconds within which the characters following a self
+     * inserted character must be available to be inserted along with it,
+     * so that text pasted without bracketed paste is inserted as a single
+     * edit and displayed once.  A value of 0 disables this.
+     */
+    String PASTE_BURST_TIMEOUT = "paste-burst-timeout";
+
     Map<String, KeyMap<Binding>> defaultKeyMaps();
 
     enum Option {
         COMPLETE_IN_WORD,
+        /** run the completers on a separate thread, a key typed meanwhile cancels the completion */
+        COMPLETE_ASYNC,
+        /** run the completers of an aggregate completer in parallel, see {@link #COMPLETER_TIMEOUT} */
+        COMPLETE_PARALLEL,
         /** use camel case completion matcher */
         COMPLETE_MATCHER_CAMELCASE,
         /** use type completion matcher */
@@ -406,6 +426,10 @@ public interface LineReader {
         HISTORY_BEEP(true),
         HISTORY_INCREMENTAL(true),
         HISTORY_TIMESTAMPED(true),
+        /** share the history file with other sessions, appending to it under a file lock */
+        HISTORY_SHARED,
+        /** write new history files in a binary format, which can be loaded without reading them entirely */
+        HISTORY_BINARY,
         /** when displaying candidates, group them by {@link Candidate#group()} */
         AUTO_GROUP(true),
         AUTO_MENU(true),
@@ -683,6 +707,17 @@ public interface LineReader {
 
     Map<String, Widget> getBuiltinWidgets();
 
+    /**
+     * The buffer being edited.
+     * <p>
+     * The changes made to the buffer, including the ones made outside of
+     * the widgets, are recorded for undo as they are made when the buffer is a
+     * {@link org.jline.reader.impl.BufferImpl}.  With other buffer implementations,
+     * a copy of the whole buffer is recorded after each widget changing it.
+     * </p>
+     *
+     * @return the buffer
+     */
     Buffer getBuffer();
 
     String getAppName();
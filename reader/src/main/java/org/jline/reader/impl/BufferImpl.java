@@ -9,6 +9,7 @@
 package org.jline.reader.impl;
 
 import java.util.Objects;
+import java.util.function.Consumer;
 
 import org.jline.reader.Buffer;
 
@@ -26,6 +27,16 @@ public class BufferImpl implements Buffer
     private int[] buffer;
     private int g0;
     private int g1;
+    // region modified since the last call to clearChanges()
+    private boolean changed;
+    private int changeStart;
+    private int changeEnd;
+    private int changeDelta;
+    // string views, cleared on edit
+    private String string;
+    private String prefix;
+    private int prefixCursor;
+    private Consumer<Edit> editListener;
 
     public BufferImpl() {
         this(64);
@@ -43,6 +54,13 @@ public class BufferImpl implements Buffer
         this.buffer = buffer.buffer.clone();
         this.g0 = buffer.g0;
         this.g1 = buffer.g1;
+        this.changed = buffer.changed;
+        this.changeStart = buffer.changeStart;
+        this.changeEnd = buffer.changeEnd;
+        this.changeDelta = buffer.changeDelta;
+        this.string = buffer.string;
+        this.prefix = buffer.prefix;
+        this.prefixCursor = buffer.prefixCursor;
     }
 
     public BufferImpl copy () {
@@ -61,7 +79,12 @@ public class BufferImpl implements Buffer
         if (cursor == length()) {
             return false;
         } else {
+            int old = buffer[adjust(cursor)];
             buffer[adjust(cursor)] = ch;
+            changed(cursor, 1, 1);
+            if (editListener != null) {
+                editListener.accept(new Edit(cursor, new String(Character.toChars(old)), new String(Character.toChars(ch))));
+            }
             return true;
         }
     }
@@ -155,6 +178,10 @@ public class BufferImpl implements Buffer
             buffer = nb;
         }
         System.arraycopy(ucps, 0, buffer, cursor, ucps.length);
+        changed(cursor, 0, ucps.length);
+        if (editListener != null && ucps.length > 0) {
+            editListener.accept(new Edit(cursor, "", new String(ucps, 0, ucps.length)));
+        }
         g0 += ucps.length;
         cursor += ucps.length;
         cursorCol = -1;
@@ -164,6 +191,10 @@ public class BufferImpl implements Buffer
         if (length() == 0) {
             return false;
         }
+        if (editListener != null) {
+            editListener.accept(new Edit(0, toString(), ""));
+        }
+        changed(0, length(), 0);
         g0 = 0;
         g1 = buffer.length;
         cursor = 0;
@@ -181,17 +212,25 @@ public class BufferImpl implements Buffer
         }
         if (end <= g0) {
             return new String(buffer, start, end - start);
-        } else if (start > g0) {
+        } else if (start >= g0) {
             return new String(buffer, g1 - g0 + start, end - start);
         } else {
-            int[] b = buffer.clone();
-            System.arraycopy(b, g1, b, g0, b.length - g1);
-            return new String(b, start, end - start);
+            int[] b = new int[end - start];
+            System.arraycopy(buffer, start, b, 0, g0 - start);
+            System.arraycopy(buffer, g1, b, g0 - start, end - g0);
+            return new String(b, 0, b.length);
         }
     }
 
     public String upToCursor() {
-        return substring(0, cursor);
+        if (cursor == length()) {
+            return toString();
+        }
+        if (prefix == null || prefixCursor != cursor) {
+            prefix = substring(0, cursor);
+            prefixCursor = cursor;
+        }
+        return prefix;
     }
 
     /**
@@ -311,9 +350,13 @@ public class BufferImpl implements Buffer
      */
     public int backspace(final int num) {
         int count = Math.max(Math.min(cursor, num), 0);
+        if (editListener != null && count > 0) {
+            editListener.accept(new Edit(cursor - count, substring(cursor - count, cursor), ""));
+        }
         moveGapToCursor();
         cursor -= count;
         g0 -= count;
+        changed(cursor, count, 0);
         cursorCol = -1;
         return count;
     }
@@ -329,8 +372,12 @@ public class BufferImpl implements Buffer
 
     public int delete(int num) {
         int count = Math.max(Math.min(length() - cursor, num), 0);
+        if (editListener != null && count > 0) {
+            editListener.accept(new Edit(cursor, substring(cursor, cursor + count), ""));
+        }
         moveGapToCursor();
         g1 += count;
+        changed(cursor, count, 0);
         cursorCol = -1;
         return count;
     }
@@ -341,7 +388,10 @@ public class BufferImpl implements Buffer
 
     @Override
     public String toString() {
-        return substring(0, length());
+        if (string == null) {
+            string = substring(0, length());
+        }
+        return string;
     }
 
     public void copyFrom(Buffer buf) {
@@ -349,6 +399,10 @@ public class BufferImpl implements Buffer
             throw new IllegalStateException();
         }
         BufferImpl that = (BufferImpl) buf;
+        if (editListener != null) {
+            editListener.accept(new Edit(0, toString(), that.toString()));
+        }
+        changed(0, length(), that.length());
         this.g0 = that.g0;
         this.g1 = that.g1;
         this.buffer = that.buffer.clone();
@@ -356,6 +410,100 @@ public class BufferImpl implements Buffer
         this.cursorCol = that.cursorCol;
     }
 
+    /**
+     * Start of the region modified since the last call to {@link #clearChanges()}.
+     *
+     * @return the index of the first modified code point
+     */
+    public int changeStart() {
+        return changed ? changeStart : 0;
+    }
+
+    /**
+     * End of the region modified since the last call to {@link #clearChanges()}.
+     *
+     * @return the index following the last modified code point
+     */
+    public int changeEnd() {
+        return changed ? changeEnd : 0;
+    }
+
+    /**
+     * Length of the modified region before it was modified.
+     *
+     * @return the number of code points replaced by the modified region
+     */
+    public int changeRemoved() {
+        return changed ? changeEnd - changeStart - changeDelta : 0;
+    }
+
+    /**
+     * Start tracking modifications from the current content.
+     */
+    public void clearChanges() {
+        changed = false;
+    }
+
+    /**
+     * Set the listener receiving each edit made to this buffer,
+     * which allows undoing edits without copying the whole buffer.
+     *
+     * @param listener the listener, or <code>null</code>
+     */
+    public void setEditListener(Consumer<Edit> listener) {
+        this.editListener = listener;
+    }
+
+    /**
+     * Apply an edit to this buffer, or revert it.
+     * The cursor is left after the inserted text.
+     *
+     * @param edit the edit
+     * @param revert whether the edit must be reverted
+     * @return <code>false</code> if the buffer doesn't contain the text
+     *         to replace, in which case it is left unchanged
+     */
+    public boolean apply(Edit edit, boolean revert) {
+        String remove = revert ? edit.inserted : edit.removed;
+        String insert = revert ? edit.removed : edit.inserted;
+        int count = remove.codePointCount(0, remove.length());
+        if (edit.position > length() || !substring(edit.position, edit.position + count).equals(remove)) {
+            return false;
+        }
+        cursor(edit.position);
+        delete(count);
+        write(insert);
+        return true;
+    }
+
+    /**
+     * Merge the replacement of <code>removed</code> code points at the given
+     * index by <code>inserted</code> code points into the modified region.
+     */
+    private void changed(int pos, int removed, int inserted) {
+        if (removed == 0 && inserted == 0) {
+            return;
+        }
+        string = null;
+        prefix = null;
+        if (!changed) {
+            changed = true;
+            changeStart = pos;
+            changeEnd = pos + inserted;
+            changeDelta = inserted - removed;
+            return;
+        }
+        int end = changeEnd;
+        if (end >= pos + removed) {
+            end += inserted - removed;
+        } else if (end > pos) {
+            end = pos + inserted;
+        }
+        changeStart = Math.min(changeStart, pos);
+        changeEnd = Math.max(end, pos + inserted);
+        changeDelta += inserted - removed;
+    }
+
     private void moveGapToCursor() {
         if (cursor < g0) {
             int l = g0 - cursor;
@@ -369,4 +517,34 @@ public class BufferImpl implements Buffer
             g1 += l;
         }
     }
+
+    /**
+     * The replacement of some text at a position of the buffer.
+     */
+    public static class Edit {
+        private final int position;
+        private final String removed;
+        private final String inserted;
+
+        public Edit(int position, String removed, String inserted) {
+            this.position = position;
+            this.removed = removed;
+            this.inserted = inserted;
+        }
+
+        /**
+         * @return the position of the edit, in code points
+         */
+        public int position() {
+            return position;
+        }
+
+        public String removed() {
+            return removed;
+        }
+
+        public String inserted() {
+            return inserted;
+        }
+    }
 }
@@ -0,0 +1,448 @@
+/*
+ * Copyright (c) 2002-2021, the original author or authors.
+ *
+ * This software is distributable under the BSD license. See the terms of the
+ * BSD license in the documentation provided with this software.
+ *
+ * https://opensource.org/licenses/BSD-3-Clause
+ */
+package org.jline.reader.impl;
+
+import java.util.AbstractList;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.Collection;
+import java.util.Collections;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Map;
+import java.util.RandomAccess;
+
+import org.jline.reader.Candidate;
+import org.jline.utils.AttributedString;
+
+/**
+ * An immutable list of completion candidates, indexed for matching.
+ * <p>
+ * Completers returning a large and stable set of candidates can build
+ * such an index once and hand it over on each completion using
+ * <code>candidates.addAll(index)</code>.  The {@link CompletionMatcherImpl}
+ * then finds the candidates starting with the word with a binary search
+ * over the sorted values, and the ones containing the word using a suffix
+ * array built on first use, instead of testing every candidate.  Typos
+ * are matched by walking the sorted values as a trie, sharing the edit
+ * distance computations between values with a common prefix, and skipping
+ * the values whose prefix is already too far from the word.
+ * </p>
+ *
+ * @see CandidateList
+ */
+public class CandidateIndex extends AbstractList<Candidate> implements RandomAccess {
+
+    private final Candidate[] candidates;
+    // distinct values, stripped from ansi sequences, and sorted
+    private final String[] keys;
+    private final List<List<Candidate>> groups;
+    private final Map<String, List<Candidate>> map;
+    // lower cased keys, and the key indexes sorted by lower cased key
+    private final String[] folded;
+    private final int[] foldedOrder;
+    private volatile long[] suffixes;
+    private volatile long[] foldedSuffixes;
+
+    public CandidateIndex(Collection<Candidate> candidates) {
+        this.candidates = candidates.toArray(new Candidate[0]);
+        Map<String, List<Candidate>> grouped = new HashMap<>();
+        for (Candidate candidate : this.candidates) {
+            grouped.computeIfAbsent(AttributedString.fromAnsi(candidate.value()).toString(), s -> new ArrayList<>())
+                    .add(candidate);
+        }
+        keys = grouped.keySet().toArray(new String[0]);
+        Arrays.sort(keys);
+        groups = new ArrayList<>(keys.length);
+        folded = new String[keys.length];
+        Integer[] order = new Integer[keys.length];
+        for (int i = 0; i < keys.length; i++) {
+            List<Candidate> group = Collections.unmodifiableList(grouped.get(keys[i]));
+            grouped.put(keys[i], group);
+            groups.add(group);
+            folded[i] = keys[i].toLowerCase();
+            order[i] = i;
+        }
+        map = Collections.unmodifiableMap(grouped);
+        Arrays.sort(order, (i1, i2) -> folded[i1].compareTo(folded[i2]));
+        foldedOrder = new int[keys.length];
+        for (int i = 0; i < keys.length; i++) {
+            foldedOrder[i] = order[i];
+        }
+    }
+
+    @Override
+    public Candidate get(int index) {
+        return candidates[index];
+    }
+
+    @Override
+    public int size() {
+        return candidates.length;
+    }
+
+    /**
+     * The candidates grouped by value.
+     */
+    Map<String, List<Candidate>> asMap() {
+        return map;
+    }
+
+    /**
+     * Adds the candidates whose value starts with the given prefix.
+     * When <code>caseInsensitive</code> is set, the prefix must be lower cased.
+     */
+    void startsWith(String prefix, boolean caseInsensitive, Map<String, List<Candidate>> out) {
+        String[] strs = caseInsensitive ? folded : keys;
+        int lo = 0;
+        int hi = keys.length;
+        while (lo < hi) {
+            int mid = (lo + hi) >>> 1;
+            if (strs[key(mid, caseInsensitive)].compareTo(prefix) < 0) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        for (int i = lo; i < keys.length && strs[key(i, caseInsensitive)].startsWith(prefix); i++) {
+            add(key(i, caseInsensitive), out);
+        }
+    }
+
+    /**
+     * Adds the candidates whose value contains the given term.
+     * When <code>caseInsensitive</code> is set, the term must be lower cased.
+     */
+    void contains(String term, boolean caseInsensitive, Map<String, List<Candidate>> out) {
+        if (term.isEmpty()) {
+            for (int i = 0; i < keys.length; i++) {
+                add(i, out);
+            }
+            return;
+        }
+        String[] strs = caseInsensitive ? folded : keys;
+        long[] sa = suffixes(caseInsensitive);
+        int lo = 0;
+        int hi = sa.length;
+        while (lo < hi) {
+            int mid = (lo + hi) >>> 1;
+            if (compare(strs, sa[mid], term) < 0) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        int[] hits = new int[16];
+        int nb = 0;
+        for (int i = lo; i < sa.length; i++) {
+            String str = strs[(int) (sa[i] >>> 32)];
+            if (!str.startsWith(term, (int) sa[i])) {
+                break;
+            }
+            if (nb == hits.length) {
+                hits = Arrays.copyOf(hits, nb * 2);
+            }
+            hits[nb++] = (int) (sa[i] >>> 32);
+        }
+        // a key may contain the term several times
+        Arrays.sort(hits, 0, nb);
+        for (int i = 0; i < nb; i++) {
+            if (i == 0 || hits[i] != hits[i - 1]) {
+                add(hits[i], out);
+            }
+        }
+    }
+
+    /**
+     * Adds the candidates whose value is at a distance less than <code>errors</code>
+     * from the given word, as computed by {@link ReaderUtils#distance(String, String)}.
+     * When <code>caseInsensitive</code> is set, the word must be lower cased.
+     */
+    void typos(String word, int errors, boolean caseInsensitive, Map<String, List<Candidate>> out) {
+        if (errors <= 0) {
+            return;
+        }
+        if (word.isEmpty()) {
+            // the distance to the empty prefix of any value is zero
+            for (int i = 0; i < keys.length; i++) {
+                add(i, out);
+            }
+            return;
+        }
+        String[] strs = caseInsensitive ? folded : keys;
+        int max = errors - 1;
+        int n = word.length();
+        DistanceTable table = new DistanceTable(word);
+        // the table columns are computed for the first depth chars of current
+        String current = "";
+        int depth = 0;
+        int p = 0;
+        while (p < keys.length) {
+            int key = key(p, caseInsensitive);
+            String str = strs[key];
+            depth = Math.min(depth, commonPrefix(current, str));
+            current = str;
+            int next = -1;
+            while (depth < str.length()) {
+                table.column(depth, str.charAt(depth));
+                depth++;
+                if (depth == n && table.get(n - 1) <= max) {
+                    // all the values with this prefix are close enough
+                    next = prefixEnd(strs, caseInsensitive, p, str, depth);
+                    for (int i = p; i < next; i++) {
+                        add(key(i, caseInsensitive), out);
+                    }
+                    break;
+                }
+                if (table.reach(depth - 1) > max) {
+                    // no value with this prefix can be close enough
+                    next = prefixEnd(strs, caseInsensitive, p, str, depth);
+                    break;
+                }
+            }
+            if (next >= 0) {
+                p = next;
+                continue;
+            }
+            int m = str.length();
+            int distance = m == 0 ? n : n < m ? Math.min(table.get(n - 1), table.get(m - 1)) : table.get(m - 1);
+            if (distance <= max) {
+                add(key, out);
+            }
+            p++;
+        }
+    }
+
+    private static int commonPrefix(String s1, String s2) {
+        int len = Math.min(s1.length(), s2.length());
+        int i = 0;
+        while (i < len && s1.charAt(i) == s2.charAt(i)) {
+            i++;
+        }
+        return i;
+    }
+
+    /**
+     * Position of the first key after <code>p</code> not starting
+     * with the first <code>len</code> chars of <code>prefix</code>.
+     */
+    private int prefixEnd(String[] strs, boolean caseInsensitive, int p, String prefix, int len) {
+        int lo = p + 1;
+        int hi = keys.length;
+        while (lo < hi) {
+            int mid = (lo + hi) >>> 1;
+            if (strs[key(mid, caseInsensitive)].regionMatches(0, prefix, 0, len)) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return lo;
+    }
+
+    private int key(int i, boolean caseInsensitive) {
+        return caseInsensitive ? foldedOrder[i] : i;
+    }
+
+    private void add(int key, Map<String, List<Candidate>> out) {
+        out.merge(keys[key], groups.get(key), CandidateIndex::concat);
+    }
+
+    static List<Candidate> concat(List<Candidate> l1, List<Candidate> l2) {
+        List<Candidate> l = new ArrayList<>(l1.size() + l2.size());
+        l.addAll(l1);
+        l.addAll(l2);
+        return l;
+    }
+
+    /**
+     * The table of {@link org.jline.utils.Levenshtein#distance(CharSequence, CharSequence)}
+     * between a word and a value, computed one column (value char) at a time,
+     * so that the columns for a common prefix can be reused.
+     */
+    private static class DistanceTable {
+
+        private final String word;
+        private int[][] table = new int[16][];
+        private char[] chars = new char[16];
+        // for each column and row, last previous column whose char is the word char
+        private int[][] lastMatch = new int[16][];
+        // lower bound of the distances in the next columns
+        private int[] reach = new int[16];
+        private final int[] swapRow;
+
+        DistanceTable(String word) {
+            this.word = word;
+            this.swapRow = new int[word.length()];
+        }
+
+        int get(int column) {
+            return table[column][word.length() - 1];
+        }
+
+        int reach(int column) {
+            return reach[column];
+        }
+
+        void column(int j, char c) {
+            int n = word.length();
+            if (j == table.length) {
+                table = Arrays.copyOf(table, j * 2);
+                chars = Arrays.copyOf(chars, j * 2);
+                lastMatch = Arrays.copyOf(lastMatch, j * 2);
+                reach = Arrays.copyOf(reach, j * 2);
+            }
+            if (table[j] == null) {
+                table[j] = new int[n];
+                lastMatch[j] = new int[n];
+            }
+            int[] col = table[j];
+            int[] last = lastMatch[j];
+            // last previous row whose char is c
+            int row = -1;
+            for (int i = 0; i < n; i++) {
+                swapRow[i] = row;
+                if (word.charAt(i) == c) {
+                    row = i;
+                }
+            }
+            int min = Integer.MAX_VALUE;
+            for (int i = 0; i < n; i++) {
+                char w = word.charAt(i);
+                int d;
+                if (j == 0) {
+                    last[i] = -1;
+                    if (i == 0) {
+                        d = w != c ? 1 : 0;
+                    } else {
+                        d = Math.min(Math.min(col[i - 1] + 1, i + 2), i + (w == c ? 0 : 1));
+                    }
+                } else {
+                    int[] prev = table[j - 1];
+                    last[i] = w == chars[j - 1] ? j - 1 : lastMatch[j - 1][i];
+                    if (i == 0) {
+                        d = Math.min(Math.min(j + 2, prev[0] + 1), j + (w == c ? 0 : 1));
+                    } else {
+                        d = Math.min(Math.min(col[i - 1] + 1, prev[i] + 1), prev[i - 1] + (w == c ? 0 : 1));
+                        int iSwap = swapRow[i];
+                        int jSwap = last[i];
+                        if (iSwap != -1 && jSwap != -1) {
+                            int pre = iSwap == 0 && jSwap == 0 ? 0
+                                    : table[Math.max(0, jSwap - 1)][Math.max(0, iSwap - 1)];
+                            d = Math.min(d, pre + (i - iSwap - 1) + (j - jSwap - 1) + 1);
+                        }
+                    }
+                }
+                col[i] = d;
+                min = Math.min(min, d);
+            }
+            reach[j] = j == 0 ? min : Math.min(min, reach[j - 1] + 1);
+            chars[j] = c;
+        }
+    }
+
+    private long[] suffixes(boolean caseInsensitive) {
+        long[] sa = caseInsensitive ? foldedSuffixes : suffixes;
+        if (sa == null) {
+            synchronized (this) {
+                sa = caseInsensitive ? foldedSuffixes : suffixes;
+                if (sa == null) {
+                    sa = buildSuffixes(caseInsensitive ? folded : keys);
+                    if (caseInsensitive) {
+                        foldedSuffixes = sa;
+                    } else {
+                        suffixes = sa;
+                    }
+                }
+            }
+        }
+        return sa;
+    }
+
+    /**
+     * Sorted suffixes of all the given strings, each one being
+     * encoded as the string index followed by the suffix offset.
+     */
+    private static long[] buildSuffixes(String[] strs) {
+        int nb = 0;
+        for (String str : strs) {
+            nb += str.length();
+        }
+        long[] sa = new long[nb];
+        int n = 0;
+        for (int i = 0; i < strs.length; i++) {
+            for (int j = 0; j < strs[i].length(); j++) {
+                sa[n++] = ((long) i << 32) | j;
+            }
+        }
+        sort(strs, sa, new long[nb], 0, nb);
+        return sa;
+    }
+
+    private static void sort(String[] strs, long[] a, long[] tmp, int lo, int hi) {
+        if (hi - lo < 16) {
+            for (int i = lo + 1; i < hi; i++) {
+                long v = a[i];
+                int j = i - 1;
+                while (j >= lo && compare(strs, a[j], v) > 0) {
+                    a[j + 1] = a[j];
+                    j--;
+                }
+                a[j + 1] = v;
+            }
+            return;
+        }
+        int mid = (lo + hi) >>> 1;
+        sort(strs, a, tmp, lo, mid);
+        sort(strs, a, tmp, mid, hi);
+        if (compare(strs, a[mid - 1], a[mid]) <= 0) {
+            return;
+        }
+        System.arraycopy(a, lo, tmp, lo, hi - lo);
+        int i = lo;
+        int j = mid;
+        for (int k = lo; k < hi; k++) {
+            if (j >= hi || i < mid && compare(strs, tmp[i], tmp[j]) <= 0) {
+                a[k] = tmp[i++];
+            } else {
+                a[k] = tmp[j++];
+            }
+        }
+    }
+
+    private static int compare(String[] strs, long s1, long s2) {
+        String a = strs[(int) (s1 >>> 32)];
+        String b = strs[(int) (s2 >>> 32)];
+        int i = (int) s1;
+        int j = (int) s2;
+        while (i < a.length() && j < b.length()) {
+            char c1 = a.charAt(i++);
+            char c2 = b.charAt(j++);
+            if (c1 != c2) {
+                return c1 - c2;
+            }
+        }
+        return (a.length() - i) - (b.length() - j);
+    }
+
+    private static int compare(String[] strs, long s, String term) {
+        String a = strs[(int) (s >>> 32)];
+        int i = (int) s;
+        int j = 0;
+        while (i < a.length() && j < term.length()) {
+            char c1 = a.charAt(i++);
+            char c2 = term.charAt(j++);
+            if (c1 != c2) {
+                return c1 - c2;
+            }
+        }
+        return (a.length() - i) - (term.length() - j);
+    }
+
+}
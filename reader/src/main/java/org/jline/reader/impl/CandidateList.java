@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2002-2021, the original author or authors.
+ *
+ * This software is distributable under the BSD license. See the terms of the
+ * BSD license in the documentation provided with this software.
+ *
+ * https://opensource.org/licenses/BSD-3-Clause
+ */
+package org.jline.reader.impl;
+
+import java.util.ArrayList;
+import java.util.Collection;
+import java.util.Comparator;
+import java.util.List;
+import java.util.function.Predicate;
+import java.util.function.UnaryOperator;
+
+import org.jline.reader.Candidate;
+
+/**
+ * The list the completers add their candidates to.
+ * <p>
+ * It keeps track of the {@link CandidateIndex}es added to it, so that
+ * the {@link CompletionMatcherImpl} can use them.  Appending candidates
+ * is the only supported modification: the indexes are forgotten
+ * as soon as the list is modified in any other way.
+ * </p>
+ */
+public class CandidateList extends ArrayList<Candidate> {
+
+    private static final long serialVersionUID = 1L;
+
+    private transient List<CandidateIndex> indexes = new ArrayList<>();
+    private transient List<Candidate> others = new ArrayList<>();
+
+    public CandidateList() {
+    }
+
+    /**
+     * The indexes added to this list, or <code>null</code> if there are none,
+     * or if they can't be used anymore.
+     */
+    List<CandidateIndex> indexes() {
+        return indexes != null && !indexes.isEmpty() ? indexes : null;
+    }
+
+    /**
+     * The candidates which have been added outside of an index.
+     */
+    List<Candidate> others() {
+        return others;
+    }
+
+    /**
+     * The candidates of this list in batches: each of the indexes added to it,
+     * followed by the other candidates, or a single batch if the indexes
+     * can't be used anymore.
+     */
+    List<List<Candidate>> batches() {
+        List<List<Candidate>> batches = new ArrayList<>();
+        if (indexes != null) {
+            batches.addAll(indexes);
+            if (!others.isEmpty()) {
+                batches.add(others);
+            }
+        } else if (!isEmpty()) {
+            batches.add(this);
+        }
+        return batches;
+    }
+
+    private void invalidate() {
+        indexes = null;
+    }
+
+    @Override
+    public boolean add(Candidate candidate) {
+        if (indexes != null) {
+            others.add(candidate);
+        }
+        return super.add(candidate);
+    }
+
+    @Override
+    public boolean addAll(Collection<? extends Candidate> c) {
+        if (indexes != null) {
+            if (c instanceof CandidateIndex) {
+                indexes.add((CandidateIndex) c);
+            } else {
+                others.addAll(c);
+            }
+        }
+        return super.addAll(c);
+    }
+
+    @Override
+    public void clear() {
+        indexes = new ArrayList<>();
+        others = new ArrayList<>();
+        super.clear();
+    }
+
+    @Override
+    public void add(int index, Candidate element) {
+        invalidate();
+        super.add(index, element);
+    }
+
+    @Override
+    public boolean addAll(int index, Collection<? extends Candidate> c) {
+        invalidate();
+        return super.addAll(index, c);
+    }
+
+    @Override
+    public Candidate set(int index, Candidate element) {
+        invalidate();
+        return super.set(index, element);
+    }
+
+    @Override
+    public Candidate remove(int index) {
+        invalidate();
+        return super.remove(index);
+    }
+
+    @Override
+    public boolean remove(Object o) {
+        invalidate();
+        return super.remove(o);
+    }
+
+    @Override
+    public boolean removeAll(Collection<?> c) {
+        invalidate();
+        return super.removeAll(c);
+    }
+
+    @Override
+    public boolean retainAll(Collection<?> c) {
+        invalidate();
+        return super.retainAll(c);
+    }
+
+    @Override
+    public boolean removeIf(Predicate<? super Candidate> filter) {
+        invalidate();
+        return super.removeIf(filter);
+    }
+
+    @Override
+    public void replaceAll(UnaryOperator<Candidate> operator) {
+        invalidate();
+        super.replaceAll(operator);
+    }
+
+    @Override
+    public void sort(Comparator<? super Candidate> c) {
+        invalidate();
+        super.sort(c);
+    }
+
+    @Override
+    protected void removeRange(int fromIndex, int toIndex) {
+        invalidate();
+        super.removeRange(fromIndex, toIndex);
+    }
+
+    @Override
+    public List<Candidate> subList(int fromIndex, int toIndex) {
+        invalidate();
+        return super.subList(fromIndex, toIndex);
+    }
+
+}
@@ -15,6 +15,7 @@ import org.jline.reader.LineReader;
 import org.jline.utils.AttributedString;
 
 import java.util.*;
+import java.util.function.BiConsumer;
 import java.util.function.Function;
 import java.util.function.Predicate;
 import java.util.regex.Pattern;
@@ -93,8 +94,10 @@ public class CompletionMatcherImpl implements CompletionMatcher {
         String wp = wdi.substring(0, line.wordCursor());
         if (prefix) {
             matchers = new ArrayList<>(Arrays.asList(
-                    simpleMatcher(s -> (caseInsensitive ? s.toLowerCase() : s).startsWith(wp)),
-                    simpleMatcher(s -> (caseInsensitive ? s.toLowerCase() : s).contains(wp))
+                    indexedMatcher(s -> (caseInsensitive ? s.toLowerCase() : s).startsWith(wp),
+                            (i, m) -> i.startsWith(wp, caseInsensitive, m)),
+                    indexedMatcher(s -> (caseInsensitive ? s.toLowerCase() : s).contains(wp),
+                            (i, m) -> i.contains(wp, caseInsensitive, m))
             ));
             if (LineReader.Option.COMPLETE_MATCHER_TYPO.isSet(options)) {
                 matchers.add(typoMatcher(wp, errors, caseInsensitive, originalGroupName));
@@ -114,8 +117,10 @@ public class CompletionMatcherImpl implements CompletionMatcher {
                 ));
             } else {
                 matchers = new ArrayList<>(Arrays.asList(
-                        simpleMatcher(s -> (caseInsensitive ? s.toLowerCase() : s).startsWith(wdi)),
-                        simpleMatcher(s -> (caseInsensitive ? s.toLowerCase() : s).contains(wdi))
+                        indexedMatcher(s -> (caseInsensitive ? s.toLowerCase() : s).startsWith(wdi),
+                                (i, m) -> i.startsWith(wdi, caseInsensitive, m)),
+                        indexedMatcher(s -> (caseInsensitive ? s.toLowerCase() : s).contains(wdi),
+                                (i, m) -> i.contains(wdi, caseInsensitive, m))
                 ));
             }
             if (LineReader.Option.COMPLETE_MATCHER_CAMELCASE.isSet(options)) {
@@ -135,20 +140,56 @@ public class CompletionMatcherImpl implements CompletionMatcher {
                 .collect(Collectors.toMap(Map.Entry::getKey, Map.Entry::getValue));
     }
 
+    /**
+     * Matcher querying the {@link CandidateIndex}es handed over by the completers,
+     * and testing the other candidates with the given predicate.
+     */
+    protected Function<Map<String, List<Candidate>>,
+            Map<String, List<Candidate>>> indexedMatcher(Predicate<String> predicate,
+                                                         BiConsumer<CandidateIndex, Map<String, List<Candidate>>> query) {
+        Function<Map<String, List<Candidate>>, Map<String, List<Candidate>>> simple = simpleMatcher(predicate);
+        return m -> {
+            if (m instanceof IndexedCandidates) {
+                IndexedCandidates ic = (IndexedCandidates) m;
+                Map<String, List<Candidate>> result = simple.apply(ic.others);
+                for (CandidateIndex index : ic.indexes) {
+                    query.accept(index, result);
+                }
+                return result;
+            }
+            return simple.apply(m);
+        };
+    }
+
     protected Function<Map<String, List<Candidate>>,
             Map<String, List<Candidate>>> typoMatcher(String word, int errors, boolean caseInsensitive, String originalGroupName) {
         return m -> {
-            Map<String, List<Candidate>> map = m.entrySet().stream()
-                    .filter(e -> ReaderUtils.distance(word, caseInsensitive ? e.getKey().toLowerCase() : e.getKey()) < errors)
-                    .collect(Collectors.toMap(Map.Entry::getKey, Map.Entry::getValue));
+            Map<String, List<Candidate>> map;
+            if (m instanceof IndexedCandidates) {
+                IndexedCandidates ic = (IndexedCandidates) m;
+                map = typos(ic.others, word, errors, caseInsensitive);
+                for (CandidateIndex index : ic.indexes) {
+                    index.typos(word, errors, caseInsensitive, map);
+                }
+            } else {
+                map = typos(m, word, errors, caseInsensitive);
+            }
             if (map.size() > 1) {
-                map.computeIfAbsent(word, w -> new ArrayList<>())
-                        .add(new Candidate(word, word, originalGroupName, null, null, null, false));
+                // do not modify the candidate lists, which may be shared with an index
+                List<Candidate> list = new ArrayList<>(map.getOrDefault(word, Collections.emptyList()));
+                list.add(new Candidate(word, word, originalGroupName, null, null, null, false));
+                map.put(word, list);
             }
             return map;
         };
     }
 
+    private static Map<String, List<Candidate>> typos(Map<String, List<Candidate>> m, String word, int errors, boolean caseInsensitive) {
+        return m.entrySet().stream()
+                .filter(e -> ReaderUtils.distance(word, caseInsensitive ? e.getKey().toLowerCase() : e.getKey()) < errors)
+                .collect(Collectors.toMap(Map.Entry::getKey, Map.Entry::getValue));
+    }
+
     protected boolean camelMatch(String word, int i, String candidate, int j) {
         if (word.length() <= i) {
             return true;
@@ -174,6 +215,17 @@ public class CompletionMatcherImpl implements CompletionMatcher {
     }
 
     private Map<String, List<Candidate>> sort(List<Candidate> candidates) {
+        if (candidates instanceof CandidateList) {
+            CandidateList list = (CandidateList) candidates;
+            List<CandidateIndex> indexes = list.indexes();
+            if (indexes != null) {
+                return new IndexedCandidates(indexes, group(list.others()));
+            }
+        }
+        return group(candidates);
+    }
+
+    private Map<String, List<Candidate>> group(List<Candidate> candidates) {
         // Build a list of sorted candidates
         Map<String, List<Candidate>> sortedCandidates = new HashMap<>();
         for (Candidate candidate : candidates) {
@@ -207,4 +259,37 @@ public class CompletionMatcherImpl implements CompletionMatcher {
         return new String(s1, 0, len);
     }
 
+    /**
+     * Candidates coming from indexes and from other completers.  The matchers
+     * which can't use the indexes see the merged candidates, which are only
+     * computed when needed.
+     */
+    private static class IndexedCandidates extends AbstractMap<String, List<Candidate>> {
+
+        final List<CandidateIndex> indexes;
+        final Map<String, List<Candidate>> others;
+        private Map<String, List<Candidate>> all;
+
+        IndexedCandidates(List<CandidateIndex> indexes, Map<String, List<Candidate>> others) {
+            this.indexes = indexes;
+            this.others = others;
+        }
+
+        @Override
+        public Set<Entry<String, List<Candidate>>> entrySet() {
+            if (all == null) {
+                if (indexes.size() == 1 && others.isEmpty()) {
+                    all = indexes.get(0).asMap();
+                } else {
+                    all = new HashMap<>();
+                    for (CandidateIndex index : indexes) {
+                        index.asMap().forEach((k, v) -> all.merge(k, v, CandidateIndex::concat));
+                    }
+                    others.forEach((k, v) -> all.merge(k, v, CandidateIndex::concat));
+                }
+            }
+            return all.entrySet();
+        }
+    }
+
 }
\ No newline at end of file
@@ -8,6 +8,10 @@
  */
 package org.jline.reader.impl;
 
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.List;
+import java.util.Objects;
 import java.util.regex.Pattern;
 
 import org.jline.reader.LineReader;
@@ -22,6 +26,15 @@ public class DefaultHighlighter implements Highlighter {
     protected Pattern errorPattern;
     protected int errorIndex = -1;
 
+    // subclasses overriding the whole buffer highlighting are not incremental
+    private final boolean incremental = !overridesHighlight(getClass());
+    private final List<Line> lines = new ArrayList<>();
+    private LineReader linesReader;
+    private int underlineStart;
+    private int underlineEnd;
+    private int negativeStart;
+    private int negativeEnd;
+
     @Override
     public void setErrorPattern(Pattern errorPattern) {
         this.errorPattern = errorPattern;
@@ -34,10 +47,97 @@ public class DefaultHighlighter implements Highlighter {
 
     @Override
     public AttributedString highlight(LineReader reader, String buffer) {
-        int underlineStart = -1;
-        int underlineEnd = -1;
-        int negativeStart = -1;
-        int negativeEnd = -1;
+        return highlightLines(reader, buffer, null, 0, 0, 0);
+    }
+
+    @Override
+    public AttributedString highlight(LineReader reader, String buffer, int start, int removed, int inserted) {
+        if (!incremental) {
+            return highlight(reader, buffer);
+        }
+        if (reader != linesReader) {
+            lines.clear();
+            linesReader = reader;
+        }
+        return highlightLines(reader, buffer, lines, start, removed, inserted);
+    }
+
+    @Override
+    public boolean isIncremental() {
+        return incremental;
+    }
+
+    /**
+     * The lexer state at the start of the buffer.
+     * Subclasses keeping a state across lines, such as an unterminated comment,
+     * return the state at the start of the buffer here.
+     *
+     * @param reader the line reader
+     * @param buffer the buffer to highlight
+     * @return the initial state, which may be <code>null</code>
+     */
+    protected Object initialState(LineReader reader, String buffer) {
+        return null;
+    }
+
+    /**
+     * Highlight a single line of the buffer, without its line separator.
+     * A line which has not been edited and starts with the same state as
+     * during the previous call is not highlighted again.
+     *
+     * @param reader the line reader
+     * @param buffer the buffer to highlight
+     * @param start the index of the line in the buffer
+     * @param end the index of the end of the line
+     * @param state the lexer state at the start of the line
+     * @param sb the builder to append the highlighted line to
+     * @return the lexer state at the end of the line, compared with {@link Object#equals(Object)}
+     */
+    protected Object highlightLine(LineReader reader, String buffer, int start, int end, Object state,
+                                   AttributedStringBuilder sb) {
+        for (int i = start; i < end; i++) {
+            AttributedStyle style = AttributedStyle.DEFAULT;
+            if (i >= underlineStart && i <= underlineEnd) {
+                style = style.underline();
+            }
+            if (i >= negativeStart && i <= negativeEnd || i == errorIndex) {
+                style = style.inverse();
+            }
+            sb.style(style);
+
+            char c = buffer.charAt(i);
+            if (c == '\t') {
+                sb.append(c);
+            } else if (c < 32) {
+                sb.style(style.inverseNeg())
+                        .append('^')
+                        .append((char) (c + '@'))
+                        .style(style);
+            } else {
+                int w = WCWidth.wcwidth(c);
+                if (w > 0) {
+                    sb.append(c);
+                }
+            }
+        }
+        return state;
+    }
+
+    /**
+     * Forget the lines highlighted by previous calls, so that the next
+     * call highlights the whole buffer.  Subclasses highlighting some
+     * buffers by other means must call this method.
+     */
+    protected void clearLines() {
+        lines.clear();
+    }
+
+    private AttributedString highlightLines(LineReader reader, String buffer, List<Line> cache,
+                                            int start, int removed, int inserted) {
+        underlineStart = -1;
+        underlineEnd = -1;
+        negativeStart = -1;
+        negativeEnd = -1;
         String search = reader.getSearchTerm();
         if (search != null && search.length() > 0) {
             underlineStart = buffer.indexOf(search);
@@ -63,46 +163,94 @@ public class DefaultHighlighter implements Highlighter {
             }
         }
 
-        AttributedStringBuilder sb = new AttributedStringBuilder();
-        for (int i = 0; i < buffer.length(); i++) {
-            if (i == underlineStart) {
-                sb.style(AttributedStyle::underline);
-            }
-            if (i == negativeStart) {
-                sb.style(AttributedStyle::inverse);
+        List<Line> old = Collections.emptyList();
+        if (cache != null) {
+            int length = -1;
+            for (Line line : cache) {
+                length += line.length + 1;
             }
-            if (i == errorIndex) {
-                sb.style(AttributedStyle::inverse);
+            if (start >= 0 && removed >= 0 && start + removed <= length
+                    && length - removed + inserted == buffer.length()) {
+                old = new ArrayList<>(cache);
             }
+            cache.clear();
+        }
 
-            char c = buffer.charAt(i);
-            if (c == '\t' || c == '\n') {
-                sb.append(c);
-            } else if (c < 32) {
-                sb.style(AttributedStyle::inverseNeg)
-                        .append('^')
-                        .append((char) (c + '@'))
-                        .style(AttributedStyle::inverseNeg);
-            } else {
-                int w = WCWidth.wcwidth(c);
-                if (w > 0) {
-                    sb.append(c);
+        // Lines ending before the edited region and lines starting after it
+        // are unchanged, the later ones being shifted by the size difference.
+        int editEnd = start + inserted;
+        int shift = inserted - removed;
+        int oldIndex = 0;
+        int oldOffset = 0;
+        Object state = initialState(reader, buffer);
+        AttributedStringBuilder sb = new AttributedStringBuilder(buffer.length());
+        int offset = 0;
+        while (true) {
+            int eol = buffer.indexOf('\n', offset);
+            int end = eol >= 0 ? eol : buffer.length();
+            Line line = null;
+            if (end < start || offset > editEnd) {
+                int target = end < start ? offset : offset - shift;
+                while (oldIndex < old.size() && oldOffset < target) {
+                    oldOffset += old.get(oldIndex++).length + 1;
+                }
+                if (oldOffset == target && oldIndex < old.size()) {
+                    line = old.get(oldIndex);
                 }
             }
-            if (i == underlineEnd) {
-                sb.style(AttributedStyle::underlineOff);
+            boolean overlay = end >= underlineStart && offset <= underlineEnd
+                    || end >= negativeStart && offset <= negativeEnd
+                    || end >= errorIndex && offset <= errorIndex;
+            if (line == null || line.length != end - offset || line.overlay || overlay
+                    || !Objects.equals(line.state, state)) {
+                AttributedStringBuilder lsb = new AttributedStringBuilder(end - offset);
+                Object endState = highlightLine(reader, buffer, offset, end, state, lsb);
+                line = new Line(end - offset, state, endState, lsb.toAttributedString(), overlay);
             }
-            if (i == negativeEnd) {
-                sb.style(AttributedStyle::inverseOff);
+            if (cache != null) {
+                cache.add(line);
             }
-            if (i == errorIndex) {
-                sb.style(AttributedStyle::inverseOff);
+            sb.append(line.styled);
+            state = line.endState;
+            if (eol < 0) {
+                break;
             }
+            sb.append('\n');
+            offset = eol + 1;
         }
+        // the cached lines do not hold the matches, which may span several lines
         if (errorPattern != null) {
             sb.styleMatches(errorPattern, AttributedStyle.INVERSE);
         }
         return sb.toAttributedString();
     }
 
+    private static boolean overridesHighlight(Class<?> clazz) {
+        try {
+            return clazz.getMethod("highlight", LineReader.class, String.class)
+                    .getDeclaringClass() != DefaultHighlighter.class;
+        } catch (NoSuchMethodException e) {
+            return false;
+        }
+    }
+
+    /**
+     * A highlighted line, with the lexer states at its start and end.
+     */
+    private static class Line {
+        final int length;
+        final Object state;
+        final Object endState;
+        final AttributedString styled;
+        final boolean overlay;
+
+        Line(int length, Object state, Object endState, AttributedString styled, boolean overlay) {
+            this.length = length;
+            this.state = state;
+            this.endState = endState;
+            this.styled = styled;
+            this.overlay = overlay;
+        }
+    }
+
 }
@@ -20,14 +20,22 @@ import java.io.InterruptedIOException;
 import java.lang.reflect.Constructor;
 import java.time.Instant;
 import java.util.*;
+import java.util.concurrent.BlockingQueue;
+import java.util.concurrent.Future;
+import java.util.concurrent.LinkedBlockingQueue;
+import java.util.concurrent.RejectedExecutionException;
+import java.util.concurrent.SynchronousQueue;
+import java.util.concurrent.ThreadPoolExecutor;
+import java.util.concurrent.TimeUnit;
 import java.util.concurrent.atomic.AtomicBoolean;
+import java.util.concurrent.atomic.AtomicInteger;
+import java.util.concurrent.atomic.AtomicReference;
 import java.util.concurrent.locks.ReentrantLock;
 import java.util.function.*;
 import java.util.regex.Matcher;
 import java.util.regex.Pattern;
 import java.util.stream.Collectors;
 import java.util.stream.Stream;
-import java.util.stream.StreamSupport;
 
 import org.jline.keymap.BindingReader;
 import org.jline.keymap.KeyMap;
@@ -39,6 +47,8 @@ import org.jline.terminal.Attributes.ControlChar;
 import org.jline.terminal.Terminal.Signal;
 import org.jline.terminal.Terminal.SignalHandler;
 import org.jline.terminal.impl.AbstractWindowsTerminal;
+import org.jline.utils.AttributedCharSequence;
+import org.jline.utils.AttributedRope;
 import org.jline.utils.AttributedString;
 import org.jline.utils.AttributedStringBuilder;
 import org.jline.utils.AttributedStyle;
@@ -46,6 +56,7 @@ import org.jline.utils.Curses;
 import org.jline.utils.Display;
 import org.jline.utils.InfoCmp.Capability;
 import org.jline.utils.Log;
+import org.jline.utils.NonBlockingReader;
 import org.jline.utils.Status;
 import org.jline.utils.StyleResolver;
 import org.jline.utils.WCWidth;
@@ -83,6 +94,8 @@ public class LineReaderImpl implements LineReader, Flushable
     public static final int    DEFAULT_ERRORS = 2;
     public static final long   DEFAULT_BLINK_MATCHING_PAREN = 500L;
     public static final long   DEFAULT_AMBIGUOUS_BINDING = 1000L;
+    public static final long   DEFAULT_COMPLETER_TIMEOUT = 200L;
+    public static final long   DEFAULT_PASTE_BURST_TIMEOUT = 1L;
     public static final String DEFAULT_SECONDARY_PROMPT_PATTERN = "%M> ";
     public static final String DEFAULT_OTHERS_GROUP_NAME = "others";
     public static final String DEFAULT_ORIGINAL_GROUP_NAME = "original";
@@ -178,6 +191,10 @@ public class LineReaderImpl implements LineReader, Flushable
     protected final Map<Option, Boolean> options = new HashMap<>();
 
     protected final Buffer buf = new BufferImpl();
+    // length of the buffer given to the incremental highlighter,
+    // and whether its chars matched the code points of the buffer
+    private int highlightedLength;
+    private boolean highlightedBmp;
     protected String tailTip = "";
     protected SuggestionType autosuggestion = SuggestionType.NONE;
 
@@ -232,8 +249,12 @@ public class LineReaderImpl implements LineReader, Flushable
 
     protected KillRing killRing = new KillRing();
 
+    // snapshots of the buffer, only used when it isn't a BufferImpl
     protected UndoTree<Buffer> undo = new UndoTree<>(this::setBuffer);
+    protected UndoTree<UndoEdit> undoEdits = new UndoTree<>(this::redoEdit, this::undoEdit);
     protected boolean isUndo;
+    // edits made to the buffer since the last widget
+    protected final List<BufferImpl.Edit> edits = new ArrayList<>();
 
     /**
      * State lock
@@ -596,6 +617,7 @@ public class LineReaderImpl implements LineReader, Flushable
             }
             nextCommandFromHistory = false;
             undo.clear();
+            undoEdits.clear();
             parsedLine = null;
             keyMap = MAIN;
 
@@ -633,7 +655,11 @@ public class LineReaderImpl implements LineReader, Flushable
 
                 callWidget(CALLBACK_INIT);
 
-                undo.newState(buf.copy());
+                if (buf instanceof BufferImpl) {
+                    ((BufferImpl) buf).setEditListener(edits::add);
+                } else {
+                    undo.newState(buf.copy());
+                }
 
                 // Draw initial prompt
                 redrawLine();
@@ -673,16 +699,26 @@ public class LineReaderImpl implements LineReader, Flushable
 
                 try {
                     lock.lock();
+                    if (!edits.isEmpty()) {
+                        // edits made outside of this loop, e.g. by another thread
+                        addUndoEdit(null, edits.get(0).position());
+                        edits.clear();
+                    }
                     // Get executable widget
-                    Buffer copy = buf.length() <= getInt(FEATURES_MAX_BUFFER_SIZE, DEFAULT_FEATURES_MAX_BUFFER_SIZE) ? buf.copy() : null;
+                    int undoCursor = buf.cursor();
+                    Buffer copy = !(buf instanceof BufferImpl)
+                            && buf.length() <= getInt(FEATURES_MAX_BUFFER_SIZE, DEFAULT_FEATURES_MAX_BUFFER_SIZE) ? buf.copy() : null;
                     Widget w = getWidget(o);
                     if (!w.apply()) {
                         beep();
                     }
-                    if (!isUndo && copy != null && buf.length() <= getInt(FEATURES_MAX_BUFFER_SIZE, DEFAULT_FEATURES_MAX_BUFFER_SIZE)
+                    if (!isUndo && !edits.isEmpty()) {
+                        addUndoEdit(o, undoCursor);
+                    } else if (!isUndo && copy != null && buf.length() <= getInt(FEATURES_MAX_BUFFER_SIZE, DEFAULT_FEATURES_MAX_BUFFER_SIZE)
                             && !copy.toString().equals(buf.toString())) {
                         undo.newState(buf.copy());
                     }
+                    edits.clear();
 
                     switch (state) {
                         case DONE:
@@ -724,6 +760,9 @@ public class LineReaderImpl implements LineReader, Flushable
 
                 this.reading = false;
 
+                if (buf instanceof BufferImpl) {
+                    ((BufferImpl) buf).setEditListener(null);
+                }
                 cleanup();
                 if (originalAttributes != null) {
                     terminal.setAttributes(originalAttributes);
@@ -2307,10 +2346,57 @@ public class LineReaderImpl implements LineReader, Flushable
         return true;
     }
 
+    /**
+     * Record the edits made by a widget.  The edits of consecutive
+     * self inserts are grouped, so that they are undone at once.
+     */
+    private void addUndoEdit(Binding binding, int cursor) {
+        boolean selfInsert = binding instanceof Reference && SELF_INSERT.equals(((Reference) binding).name());
+        UndoEdit last = undoEdits.current();
+        if (selfInsert && last != null && last.selfInsert && !undoEdits.canRedo() && last.redoCursor == cursor) {
+            last.edits.addAll(edits);
+        } else {
+            last = new UndoEdit(cursor, selfInsert);
+            last.edits.addAll(edits);
+            undoEdits.newState(last);
+        }
+        last.redoCursor = buf.cursor();
+    }
+
+    private void undoEdit(UndoEdit edit) {
+        for (int i = edit.edits.size() - 1; i >= 0; i--) {
+            if (!((BufferImpl) buf).apply(edit.edits.get(i), true)) {
+                dropUndo();
+                return;
+            }
+        }
+        buf.cursor(edit.cursor);
+    }
+
+    private void redoEdit(UndoEdit edit) {
+        for (BufferImpl.Edit e : edit.edits) {
+            if (!((BufferImpl) buf).apply(e, false)) {
+                dropUndo();
+                return;
+            }
+        }
+        buf.cursor(edit.redoCursor);
+    }
+
+    /**
+     * Forget the undo history, which doesn't match the buffer anymore,
+     * keeping the buffer as it is.
+     */
+    private void dropUndo() {
+        Log.debug("Undo history out of sync with the buffer, dropping it");
+        undoEdits.clear();
+    }
+
     protected boolean undo() {
         isUndo = true;
-        if (undo.canUndo()) {
-            undo.undo();
+        UndoTree<?> tree = buf instanceof BufferImpl ? undoEdits : undo;
+        if (tree.canUndo()) {
+            tree.undo();
             return true;
         }
         return false;
@@ -2318,8 +2404,9 @@ public class LineReaderImpl implements LineReader, Flushable
 
     protected boolean redo() {
         isUndo = true;
-        if (undo.canRedo()) {
-            undo.redo();
+        UndoTree<?> tree = buf instanceof BufferImpl ? undoEdits : undo;
+        if (tree.canRedo()) {
+            tree.redo();
             return true;
         }
         return false;
@@ -2639,11 +2726,15 @@ public class LineReaderImpl implements LineReader, Flushable
                                 .max(Comparator.comparing(Pair::getV))
                                 .orElse(null);
                         if (pair == null) {
-                            pair = StreamSupport.stream(
-                                    Spliterators.spliteratorUnknownSize(history.reverseIterator(searchIndex < 0 ? history.last() : searchIndex - 1), Spliterator.ORDERED), false)
-                                    .flatMap(e -> matches(pat, e.line(), e.index()).stream())
-                                    .findFirst()
-                                    .orElse(null);
+                            // let the history find the candidate entries, then check the pattern
+                            int start = searchIndex < 0 ? history.last() + 1 : searchIndex;
+                            int idx;
+                            while (pair == null && (idx = history.searchBackwards(searchTerm.toString(), start, false, true)) >= 0) {
+                                pair = matches(pat, history.get(idx), idx).stream()
+                                        .findFirst()
+                                        .orElse(null);
+                                start = idx;
+                            }
                         }
                     } else {
                         boolean nextOnly = next;
@@ -2652,11 +2743,14 @@ public class LineReaderImpl implements LineReader, Flushable
                                 .min(Comparator.comparing(Pair::getV))
                                 .orElse(null);
                         if (pair == null) {
-                            pair = StreamSupport.stream(
-                                    Spliterators.spliteratorUnknownSize(history.iterator((searchIndex < 0 ? history.last() : searchIndex) + 1), Spliterator.ORDERED), false)
-                                    .flatMap(e -> matches(pat, e.line(), e.index()).stream())
-                                    .findFirst()
-                                    .orElse(null);
+                            int start = (searchIndex < 0 ? history.last() : searchIndex) + 1;
+                            int idx;
+                            while (pair == null && (idx = history.searchForwards(searchTerm.toString(), start, false, true)) >= 0) {
+                                pair = matches(pat, history.get(idx), idx).stream()
+                                        .findFirst()
+                                        .orElse(null);
+                                start = idx + 1;
+                            }
                             if (pair == null && searchIndex >= 0) {
                                 pair = matches(pat, originalBuffer.toString(), -1).stream()
                                         .min(Comparator.comparing(Pair::getV))
@@ -2835,49 +2929,17 @@ public class LineReaderImpl implements LineReader, Flushable
     }
 
     public int searchBackwards(String searchTerm, int startIndex, boolean startsWith) {
-        boolean caseInsensitive = isSet(Option.CASE_INSENSITIVE_SEARCH);
-        if (caseInsensitive) {
-            searchTerm = searchTerm.toLowerCase();
-        }
-        ListIterator<History.Entry> it = history.iterator(startIndex);
-        while (it.hasPrevious()) {
-            History.Entry e = it.previous();
-            String line = e.line();
-            if (caseInsensitive) {
-                line = line.toLowerCase();
-            }
-            int idx = line.indexOf(searchTerm);
-            if ((startsWith && idx == 0) || (!startsWith && idx >= 0)) {
-                return e.index();
-            }
-        }
-        return -1;
+        return history.searchBackwards(searchTerm, startIndex, startsWith, isSet(Option.CASE_INSENSITIVE_SEARCH));
     }
 
     public int searchForwards(String searchTerm, int startIndex, boolean startsWith) {
-        boolean caseInsensitive = isSet(Option.CASE_INSENSITIVE_SEARCH);
-        if (caseInsensitive) {
-            searchTerm = searchTerm.toLowerCase();
-        }
         if (startIndex > history.last()) {
             startIndex = history.last();
         }
-        ListIterator<History.Entry> it = history.iterator(startIndex);
-        if (searchIndex != -1 && it.hasNext()) {
-            it.next();
+        if (searchIndex != -1 && startIndex <= history.last()) {
+            startIndex++;
         }
-        while (it.hasNext()) {
-            History.Entry e = it.next();
-            String line = e.line();
-            if (caseInsensitive) {
-                line = line.toLowerCase();
-            }
-            int idx = line.indexOf(searchTerm);
-            if ((startsWith && idx == 0) || (!startsWith && idx >= 0)) {
-                return e.index();
-            }
-        }
-        return -1;
+        return history.searchForwards(searchTerm, startIndex, startsWith, isSet(Option.CASE_INSENSITIVE_SEARCH));
     }
 
     /**
@@ -2993,9 +3055,48 @@ public class LineReaderImpl implements LineReader, Flushable
         for (int count = this.count; count > 0; count--) {
             putString(getLastBinding());
         }
+        if (count == 1) {
+            insertBurst();
+        }
         return true;
     }
 
+    /**
+     * Insert the characters following a self inserted character when they are
+     * already available, as when text is pasted into a terminal which does not
+     * support bracketed paste.  Only characters which would be self inserted
+     * are consumed, so that the remaining input is handled as usual.
+     */
+    private void insertBurst() {
+        long timeout = getLong(PASTE_BURST_TIMEOUT, DEFAULT_PASTE_BURST_TIMEOUT);
+        if (timeout <= 0) {
+            return;
+        }
+        KeyMap<Binding> keys = getKeys();
+        Reference selfInsert = new Reference(SELF_INSERT);
+        int[] remaining = new int[1];
+        StringBuilder sb = new StringBuilder();
+        while (true) {
+            int c = bindingReader.peekCharacter(timeout);
+            if (c < ' ' || c == 127) {
+                break;
+            }
+            Binding o = keys.getBound(new String(Character.toChars(c)), remaining);
+            if (o == null && remaining[0] > 0) {
+                o = c >= KeyMap.KEYMAP_LENGTH ? keys.getUnicode() : keys.getNomatch();
+            } else if (remaining[0] != 0) {
+                o = null;
+            }
+            if (!selfInsert.equals(o)) {
+                break;
+            }
+            sb.appendCodePoint(bindingReader.readCharacter());
+        }
+        if (sb.length() > 0) {
+            putString(sb);
+        }
+    }
+
     protected boolean selfInsertUnmeta() {
         if (getLastBinding().charAt(0) == '\u001b') {
             String s = getLastBinding().substring(1);
@@ -3803,7 +3904,7 @@ public class LineReaderImpl implements LineReader, Flushable
                 AttributedStringBuilder sb = new AttributedStringBuilder().tabs(TAB_WIDTH);
 
                 sb.append(prompt);
-                concat(getHighlightedBuffer(buf.toString()).columnSplitLength(Integer.MAX_VALUE), sb);
+                concat(getHighlightedBuffer().columnSplitLength(Integer.MAX_VALUE), sb);
                 AttributedString full = sb.toAttributedString();
 
                 sb.setLength(0);
@@ -3845,12 +3946,12 @@ public class LineReaderImpl implements LineReader, Flushable
             }
 
             List<AttributedString> secondaryPrompts = new ArrayList<>();
-            AttributedString full = getDisplayedBufferWithPrompts(secondaryPrompts);
+            AttributedCharSequence full = displayedBufferWithPrompts(secondaryPrompts);
 
             List<AttributedString> newLines;
             if (size.getColumns() <= 0) {
                 newLines = new ArrayList<>();
-                newLines.add(full);
+                newLines.add(full.toAttributedString());
             } else {
                 newLines = full.columnSplitLength(size.getColumns(), true, display.delayLineWrap());
             }
@@ -3873,13 +3974,12 @@ public class LineReaderImpl implements LineReader, Flushable
             int cursorNewLinesId = -1;
             int cursorColPos = -1;
             if (size.getColumns() > 0) {
-                AttributedStringBuilder sb = new AttributedStringBuilder().tabs(TAB_WIDTH);
-                sb.append(prompt);
                 String buffer = buf.upToCursor();
                 if (maskingCallback != null) {
                     buffer = maskingCallback.display(buffer);
                 }
-                sb.append(insertSecondaryPrompts(new AttributedString(buffer), secondaryPrompts, false));
+                AttributedCharSequence sb = compose(Arrays.asList(prompt,
+                        insertSecondaryPrompts(new AttributedString(buffer), secondaryPrompts, false)));
                 List<AttributedString> promptLines = sb.columnSplitLength(size.getColumns(), false, display.delayLineWrap());
                 if (!promptLines.isEmpty()) {
                     cursorNewLinesId = promptLines.size() - 1;
@@ -3977,19 +4077,26 @@ public class LineReaderImpl implements LineReader, Flushable
      * @return the displayed string including the buffer, left prompts and the help below
      */
     public AttributedString getDisplayedBufferWithPrompts(List<AttributedString> secondaryPrompts) {
-        AttributedString attBuf = getHighlightedBuffer(buf.toString());
+        return displayedBufferWithPrompts(secondaryPrompts).toAttributedString();
+    }
 
-        AttributedString tNewBuf = insertSecondaryPrompts(attBuf, secondaryPrompts);
-        AttributedStringBuilder full = new AttributedStringBuilder().tabs(TAB_WIDTH);
-        full.append(prompt);
-        full.append(tNewBuf);
+    /**
+     * Compose the displayed string, referencing the prompts and the buffer rather than copying them.
+     */
+    private AttributedCharSequence displayedBufferWithPrompts(List<AttributedString> secondaryPrompts) {
+        AttributedString attBuf = getHighlightedBuffer();
+
+        AttributedCharSequence tNewBuf = insertSecondaryPrompts(attBuf, secondaryPrompts);
+        List<AttributedCharSequence> full = new ArrayList<>();
+        full.add(prompt);
+        full.add(tNewBuf);
         if (doAutosuggestion && !isTerminalDumb()) {
             String lastBinding = getLastBinding() != null ? getLastBinding() : "";
             if (autosuggestion == SuggestionType.HISTORY) {
                 AttributedStringBuilder sb = new AttributedStringBuilder();
                 tailTip = matchPreviousCommand(buf.toString());
                 sb.styled(AttributedStyle::faint, tailTip);
-                full.append(sb.toAttributedString());
+                full.add(sb.toAttributedString());
             } else if (autosuggestion == SuggestionType.COMPLETER) {
                 if (buf.length() >= getInt(SUGGESTIONS_MIN_BUFFER_SIZE, DEFAULT_SUGGESTIONS_MIN_BUFFER_SIZE)
                         && buf.length() == buf.cursor()
@@ -4020,25 +4127,62 @@ public class LineReaderImpl implements LineReader, Flushable
                         }
                     }
                     sb.styled(AttributedStyle::faint, tailTip);
-                    full.append(sb.toAttributedString());
+                    full.add(sb.toAttributedString());
                 }
             }
         }
         if (post != null) {
-            full.append("\n");
-            full.append(post.get());
+            full.add(AttributedString.NEWLINE);
+            full.add(post.get());
         }
         doAutosuggestion = true;
-        return full.toAttributedString();
+        return compose(full);
     }
 
-    private AttributedString getHighlightedBuffer(String buffer) {
+    /**
+     * Concatenate the given strings without copying them, unless tabs need to be expanded.
+     */
+    private AttributedCharSequence compose(List<? extends AttributedCharSequence> strings) {
+        for (AttributedCharSequence str : strings) {
+            if (str.contains('\t')) {
+                AttributedStringBuilder sb = new AttributedStringBuilder().tabs(TAB_WIDTH);
+                for (AttributedCharSequence s : strings) {
+                    sb.append(s);
+                }
+                return sb;
+            }
+        }
+        return new AttributedRope(strings);
+    }
+
+    private AttributedString getHighlightedBuffer() {
+        String buffer = buf.toString();
         if (maskingCallback != null) {
             buffer = maskingCallback.display(buffer);
         }
-        if (highlighter != null && !isSet(Option.DISABLE_HIGHLIGHTER)
-                && buffer.length() < getInt(FEATURES_MAX_BUFFER_SIZE, DEFAULT_FEATURES_MAX_BUFFER_SIZE)) {
-            return highlighter.highlight(this, buffer);
+        if (highlighter != null && !isSet(Option.DISABLE_HIGHLIGHTER)) {
+            if (highlighter.isIncremental()) {
+                // The edited region is tracked in code points, use it only if they map
+                // to chars, both in the previous buffer and in the new one
+                boolean bmp = maskingCallback == null && buffer.length() == buf.length();
+                int start = 0;
+                int removed = highlightedLength;
+                int inserted = buffer.length();
+                if (buf instanceof BufferImpl) {
+                    BufferImpl b = (BufferImpl) buf;
+                    if (bmp && highlightedBmp) {
+                        start = b.changeStart();
+                        removed = b.changeRemoved();
+                        inserted = b.changeEnd() - start;
+                    }
+                    b.clearChanges();
+                }
+                highlightedLength = buffer.length();
+                highlightedBmp = bmp;
+                return highlighter.highlight(this, buffer, start, removed, inserted);
+            } else if (buffer.length() < getInt(FEATURES_MAX_BUFFER_SIZE, DEFAULT_FEATURES_MAX_BUFFER_SIZE)) {
+                return highlighter.highlight(this, buffer);
+            }
         }
         return new AttributedString(buffer);
     }
@@ -4150,14 +4294,14 @@ public class LineReaderImpl implements LineReader, Flushable
         return AttributedString.join(null, parts);
     }
 
-    private AttributedString insertSecondaryPrompts(AttributedString str, List<AttributedString> prompts) {
+    private AttributedCharSequence insertSecondaryPrompts(AttributedString str, List<AttributedString> prompts) {
         return insertSecondaryPrompts(str, prompts, true);
     }
 
-    private AttributedString insertSecondaryPrompts(AttributedString strAtt, List<AttributedString> prompts, boolean computePrompts) {
+    private AttributedCharSequence insertSecondaryPrompts(AttributedString strAtt, List<AttributedString> prompts, boolean computePrompts) {
         Objects.requireNonNull(prompts);
         List<AttributedString> lines = strAtt.columnSplitLength(Integer.MAX_VALUE);
-        AttributedStringBuilder sb = new AttributedStringBuilder();
+        List<AttributedString> parts = new ArrayList<>();
         String secondaryPromptPattern = getString(SECONDARY_PROMPT_PATTERN, DEFAULT_SECONDARY_PROMPT_PATTERN);
         boolean needsMessage = secondaryPromptPattern.contains("%M")
                 && strAtt.length() < getInt(FEATURES_MAX_BUFFER_SIZE, DEFAULT_FEATURES_MAX_BUFFER_SIZE);
@@ -4190,13 +4334,14 @@ public class LineReaderImpl implements LineReader, Flushable
         }
         int line = 0;
         while (line < lines.size() - 1) {
-            sb.append(lines.get(line)).append("\n");
-            buf.append(lines.get(line)).append("\n");
+            parts.add(lines.get(line));
+            parts.add(AttributedString.NEWLINE);
             AttributedString prompt;
             if (computePrompts) {
                 String missing = "";
                 if (needsMessage) {
                     if (missings.isEmpty()) {
+                        buf.append(lines.get(line)).append("\n");
                         try {
                             parser.parse(buf.toString(), buf.length(), ParseContext.SECONDARY_PROMPT);
                         } catch (EOFError e) {
@@ -4213,12 +4358,11 @@ public class LineReaderImpl implements LineReader, Flushable
                 prompt = prompts.get(line);
             }
             prompts.add(prompt);
-            sb.append(prompt);
+            parts.add(prompt);
             line++;
         }
-        sb.append(lines.get(line));
-        buf.append(lines.get(line));
-        return sb.toAttributedString();
+        parts.add(lines.get(line));
+        return new AttributedRope(parts);
     }
 
     private AttributedString addRightPrompt(AttributedString prompt, AttributedString line) {
@@ -4376,10 +4520,16 @@ public class LineReaderImpl implements LineReader, Flushable
         }
 
         // Find completion candidates
-        List<Candidate> candidates = new ArrayList<>();
+        List<Candidate> candidates = new CandidateList();
         try {
             if (completer != null) {
-                completer.complete(this, line, candidates);
+                if (isSet(Option.COMPLETE_ASYNC) && !forSuggestion) {
+                    if (!completeAsync(line, candidates, prefix)) {
+                        return false;
+                    }
+                } else {
+                    completer.complete(this, line, candidates);
+                }
             }
         } catch (Exception e) {
             Log.info("Error while finding completion candidates", e);
@@ -4579,6 +4729,154 @@ public class LineReaderImpl implements LineReader, Flushable
                 .thenComparing(String::toLowerCase, Comparator.naturalOrder());
     }
 
+    /**
+     * Runs the completer on a separate thread, displaying the matching candidates
+     * as the batches come in.  A key typed in the meantime cancels the completion
+     * and is left to be read as usual.  The completion runs on the calling thread
+     * if all the completion threads are still busy with cancelled completions.
+     *
+     * @return <code>false</code> if the completion has been cancelled
+     */
+    private boolean completeAsync(CompletingParsedLine line, List<Candidate> candidates, boolean prefix) throws Exception {
+        List<Candidate> end = new ArrayList<>();
+        BlockingQueue<List<Candidate>> batches = new LinkedBlockingQueue<>();
+        AtomicReference<Exception> error = new AtomicReference<>();
+        // completers may not stop when interrupted, so their batches are dropped
+        AtomicBoolean cancelled = new AtomicBoolean();
+        Future<?> worker;
+        try {
+            worker = CompletionPool.EXECUTOR.submit(() -> {
+                try {
+                    completeIncrementally(this, completer, line, batch -> {
+                        if (!cancelled.get()) {
+                            // indexes are immutable and handed over as is
+                            batches.add(batch instanceof CandidateIndex ? batch : new ArrayList<>(batch));
+                        }
+                    });
+                } catch (Exception e) {
+                    error.set(e);
+                } finally {
+                    batches.add(end);
+                }
+            });
+        } catch (RejectedExecutionException e) {
+            Log.debug("No thread available for the completion");
+            completer.complete(this, line, candidates);
+            return true;
+        }
+
+        boolean caseInsensitive = isSet(Option.CASE_INSENSITIVE);
+        completionMatcher.compile(options, prefix, line, caseInsensitive, getInt(ERRORS, DEFAULT_ERRORS), getOriginalGroupName());
+        boolean input = true;
+        boolean changed = false;
+        try {
+            while (true) {
+                List<Candidate> batch = input ? batches.poll() : batches.poll(50, TimeUnit.MILLISECONDS);
+                if (batch == end) {
+                    break;
+                } else if (batch != null) {
+                    candidates.addAll(batch);
+                    changed = true;
+                    continue;
+                }
+                if (changed) {
+                    if (!dumb) {
+                        displayPartialCompletion(completionMatcher.matches(candidates), line.word(), caseInsensitive);
+                    }
+                    changed = false;
+                }
+                if (input) {
+                    int c;
+                    if (lock.isHeldByCurrentThread()) {
+                        try {
+                            lock.unlock();
+                            c = peekCharacter(50);
+                        } finally {
+                            lock.lock();
+                        }
+                    } else {
+                        c = peekCharacter(50);
+                    }
+                    if (c >= 0) {
+                        Log.debug("Completion cancelled by a key");
+                        return false;
+                    }
+                    // no more input to wait for
+                    input = c == NonBlockingReader.READ_EXPIRED;
+                }
+            }
+        } catch (InterruptedException e) {
+            throw new IOError(new InterruptedIOException());
+        } finally {
+            cancelled.set(true);
+            worker.cancel(true);
+            post = null;
+        }
+        if (error.get() != null) {
+            throw error.get();
+        }
+        return true;
+    }
+
+    /**
+     * Hands over the candidates of the completer in batches.  Unless the completer
+     * overrides {@link Completer#completeIncrementally(LineReader, ParsedLine, Consumer)},
+     * the candidates are collected in a {@link CandidateList}, and each of the
+     * {@link CandidateIndex}es added is handed over as is so that it can still
+     * be used for matching.
+     */
+    static void completeIncrementally(LineReader reader, Completer completer, ParsedLine line,
+                                      Consumer<List<Candidate>> batches) {
+        if (overridesCompleteIncrementally(completer.getClass())) {
+            completer.completeIncrementally(reader, line, batches);
+        } else {
+            CandidateList candidates = new CandidateList();
+            completer.complete(reader, line, candidates);
+            candidates.batches().forEach(batches);
+        }
+    }
+
+    private static boolean overridesCompleteIncrementally(Class<?> clazz) {
+        try {
+            return clazz.getMethod("completeIncrementally", LineReader.class, ParsedLine.class, Consumer.class)
+                    .getDeclaringClass() != Completer.class;
+        } catch (NoSuchMethodException e) {
+            return false;
+        }
+    }
+
+    private static class CompletionPool {
+        static final int THREADS = 4;
+        static final ThreadPoolExecutor EXECUTOR;
+
+        static {
+            AtomicInteger counter = new AtomicInteger();
+            // no queue: a completion never waits for a cancelled one to finish
+            EXECUTOR = new ThreadPoolExecutor(0, THREADS, 30, TimeUnit.SECONDS,
+                    new SynchronousQueue<>(), r -> {
+                        Thread thread = new Thread(r, "JLine completion-" + counter.incrementAndGet());
+                        thread.setDaemon(true);
+                        return thread;
+                    });
+        }
+    }
+
+    private void displayPartialCompletion(List<Candidate> possible, String completed, boolean caseInsensitive) {
+        List<Candidate> cands = possible.stream()
+                .sorted(getCandidateComparator(caseInsensitive, completed))
+                .collect(Collectors.toList());
+        post = () -> {
+            AttributedCharSequence t = insertSecondaryPrompts(AttributedStringBuilder.append(prompt, buf.toString()), new ArrayList<>());
+            int pl = t.columnSplitLength(size.getColumns(), false, display.delayLineWrap()).size();
+            PostResult pr = computePost(cands, null, null, completed);
+            if (pr.lines >= size.getRows() - pl) {
+                return new AttributedString(getAppName() + ": " + cands.size() + " possibilities so far...");
+            }
+            return pr.post;
+        };
+        redisplay();
+    }
+
     private void mergeCandidates(List<Candidate> possible) {
         // Merge candidates if the have the same key
         Map<String, List<Candidate>> keyedCandidates = new HashMap<>();
@@ -4627,7 +4925,7 @@ public class LineReaderImpl implements LineReader, Flushable
     }
 
     private int promptLines() {
-        AttributedString text = insertSecondaryPrompts(AttributedStringBuilder.append(prompt, buf.toString()), new ArrayList<>());
+        AttributedCharSequence text = insertSecondaryPrompts(AttributedStringBuilder.append(prompt, buf.toString()), new ArrayList<>());
         return text.columnSplitLength(size.getColumns(), false, display.delayLineWrap()).size();
     }
 
@@ -4892,7 +5190,7 @@ public class LineReaderImpl implements LineReader, Flushable
         // for confirmation, display the list
         // and redraw the line at the bottom
         mergeCandidates(possible);
-        AttributedString text = insertSecondaryPrompts(AttributedStringBuilder.append(prompt, buf.toString()), new ArrayList<>());
+        AttributedCharSequence text = insertSecondaryPrompts(AttributedStringBuilder.append(prompt, buf.toString()), new ArrayList<>());
         int promptLines = text.columnSplitLength(size.getColumns(), false, display.delayLineWrap()).size();
         PostResult postResult = computePost(possible, null, null, completed);
         int lines = postResult.lines;
@@ -4935,7 +5233,7 @@ public class LineReaderImpl implements LineReader, Flushable
                 candidateStartPosition = candidateStartPosition(cands);
             }
             post = () -> {
-                AttributedString t = insertSecondaryPrompts(AttributedStringBuilder.append(prompt, buf.toString()), new ArrayList<>());
+                AttributedCharSequence t = insertSecondaryPrompts(AttributedStringBuilder.append(prompt, buf.toString()), new ArrayList<>());
                 int pl = t.columnSplitLength(size.getColumns(), false, display.delayLineWrap()).size();
                 PostResult pr = computePost(cands, null, null, current);
                 if (pr.lines >= size.getRows() - pl) {
@@ -5722,11 +6020,10 @@ public class LineReaderImpl implements LineReader, Flushable
             bindingReader.runMacro(tsb.toString());
 
             List<AttributedString> secondaryPrompts = new ArrayList<>();
-            getDisplayedBufferWithPrompts(secondaryPrompts);
+            displayedBufferWithPrompts(secondaryPrompts);
 
-            AttributedStringBuilder sb = new AttributedStringBuilder().tabs(TAB_WIDTH);
-            sb.append(prompt);
-            sb.append(insertSecondaryPrompts(new AttributedString(buf.upToCursor()), secondaryPrompts, false));
+            AttributedCharSequence sb = compose(Arrays.asList(prompt,
+                    insertSecondaryPrompts(new AttributedString(buf.upToCursor()), secondaryPrompts, false)));
             List<AttributedString> promptLines = sb.columnSplitLength(size.getColumns(), false, display.delayLineWrap());
 
             int currentLine = promptLines.size() - 1;
@@ -6240,4 +6537,19 @@ public class LineReaderImpl implements LineReader, Flushable
         }
     }
 
+
+    /**
+     * The edits made to the buffer by a widget, or by consecutive self inserts.
+     */
+    protected static class UndoEdit {
+        final List<BufferImpl.Edit> edits = new ArrayList<>();
+        final int cursor;
+        final boolean selfInsert;
+        int redoCursor;
+
+        UndoEdit(int cursor, boolean selfInsert) {
+            this.cursor = cursor;
+            this.selfInsert = selfInsert;
+        }
+    }
 }
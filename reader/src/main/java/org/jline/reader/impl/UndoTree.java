@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2002-2016, the original author or authors.
+ * Copyright (c) 2002-2021, the original author or authors.
  *
  * This software is distributable under the BSD license. See the terms of the
  * BSD license in the documentation provided with this software.
@@ -12,22 +12,43 @@ import java.util.function.Consumer;
 
 /**
  * Simple undo tree.
- * Note that the first added state can't be undone
+ * <p>
+ * The tree either records states or changes.  When recording states,
+ * undoing restores the previous state, and the first added state can't
+ * be undone.  When recording changes, undoing reverts the current change,
+ * so that each node only holds what has been modified.
+ * </p>
  */
 public class UndoTree<T> {
 
     private final Consumer<T> state;
+    private final Consumer<T> revert;
     private final Node parent;
     private Node current;
 
+    /**
+     * Create an undo tree of states.
+     * @param s restores a state
+     */
     public UndoTree(Consumer<T> s) {
-        state = s;
+        this(s, null);
+    }
+
+    /**
+     * Create an undo tree of changes.
+     * @param apply applies a change again
+     * @param revert reverts a change
+     */
+    public UndoTree(Consumer<T> apply, Consumer<T> revert) {
+        this.state = apply;
+        this.revert = revert;
         parent = new Node(null);
         parent.left = parent;
         clear();
     }
 
     public void clear() {
+        parent.right = null;
         current = parent;
     }
 
@@ -38,8 +59,16 @@ public class UndoTree<T> {
         current = node;
     }
 
+    /**
+     * The last added state or change which has not been undone.
+     * @return the current state or change, or <code>null</code> if none
+     */
+    public T current() {
+        return current.state;
+    }
+
     public boolean canUndo() {
-        return current.left != parent;
+        return revert != null ? current != parent : current.left != parent;
     }
 
     public boolean canRedo() {
@@ -50,8 +79,13 @@ public class UndoTree<T> {
         if (!canUndo()) {
             throw new IllegalStateException("Cannot undo.");
         }
-        current = current.left;
-        state.accept(current.state);
+        if (revert != null) {
+            revert.accept(current.state);
+            current = current.left;
+        } else {
+            current = current.left;
+            state.accept(current.state);
+        }
     }
 
     public void redo() {
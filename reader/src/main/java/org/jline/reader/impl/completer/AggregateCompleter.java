@@ -8,18 +8,41 @@
  */
 package org.jline.reader.impl.completer;
 
+import java.util.ArrayList;
 import java.util.Arrays;
 import java.util.Collection;
 import java.util.List;
 import java.util.Objects;
+import java.util.concurrent.Callable;
+import java.util.concurrent.ExecutionException;
+import java.util.concurrent.Executor;
+import java.util.concurrent.FutureTask;
+import java.util.concurrent.LinkedBlockingQueue;
+import java.util.concurrent.RejectedExecutionException;
+import java.util.concurrent.ThreadPoolExecutor;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.TimeoutException;
+import java.util.concurrent.atomic.AtomicInteger;
+import java.util.function.Consumer;
 
 import org.jline.reader.Candidate;
 import org.jline.reader.Completer;
 import org.jline.reader.LineReader;
 import org.jline.reader.ParsedLine;
+import org.jline.reader.impl.LineReaderImpl;
+import org.jline.reader.impl.ReaderUtils;
+import org.jline.utils.Log;
 
 /**
  * Completer which contains multiple completers and aggregates them together.
+ * <p>
+ * When the {@link LineReader.Option#COMPLETE_PARALLEL} option is set, the
+ * completers are run concurrently on a bounded pool of threads.  Their
+ * candidates are still merged in the order of the completers.  The
+ * completers which fail, or which have not finished within
+ * {@link LineReader#COMPLETER_TIMEOUT} milliseconds of the start of the
+ * completion, are cancelled and their candidates dropped.
+ * </p>
  *
  * @author <a href="mailto:jason@planet57.com">Jason Dillon</a>
  * @since 2.3
@@ -27,7 +50,10 @@ import org.jline.reader.ParsedLine;
 public class AggregateCompleter
     implements Completer
 {
+    private static final ThreadLocal<Boolean> IN_POOL = new ThreadLocal<>();
+
     private final Collection<Completer> completers;
+    private volatile Executor executor;
 
     /**
      * Construct an AggregateCompleter with the given completers.
@@ -59,6 +85,17 @@ public class AggregateCompleter
         return completers;
     }
 
+    /**
+     * Set the executor used to run the completers in parallel.
+     * By default, a pool shared by all aggregate completers and limited
+     * to the number of available processors is used.
+     *
+     * @param executor the executor, or <code>null</code> to use the shared pool
+     */
+    public void setExecutor(Executor executor) {
+        this.executor = executor;
+    }
+
     /**
      * Perform a completion operation across all aggregated completers.
      *
@@ -70,7 +107,138 @@ public class AggregateCompleter
     public void complete(LineReader reader, final ParsedLine line, final List<Candidate> candidates) {
         Objects.requireNonNull(line);
         Objects.requireNonNull(candidates);
-        completers.forEach(c -> c.complete(reader, line, candidates));
+        if (isParallel(reader)) {
+            completeParallel(reader, line, candidates::addAll);
+        } else {
+            completers.forEach(c -> c.complete(reader, line, candidates));
+        }
+    }
+
+    /**
+     * Hands over the candidates of each aggregated completer as soon as they are found.
+     *
+     * @see Completer#completeIncrementally(LineReader, ParsedLine, Consumer)
+     */
+    @Override
+    public void completeIncrementally(LineReader reader, ParsedLine line, Consumer<List<Candidate>> batches) {
+        Objects.requireNonNull(line);
+        Objects.requireNonNull(batches);
+        if (isParallel(reader)) {
+            completeParallel(reader, line, batches);
+            return;
+        }
+        for (Completer completer : completers) {
+            if (Thread.currentThread().isInterrupted()) {
+                return;
+            }
+            completer.completeIncrementally(reader, line, batches);
+        }
+    }
+
+    private boolean isParallel(LineReader reader) {
+        // nested aggregates run sequentially on the thread of their parent,
+        // the pool would otherwise be filled with threads waiting for each other
+        return reader != null
+                && completers.size() > 1
+                && reader.isSet(LineReader.Option.COMPLETE_PARALLEL)
+                && IN_POOL.get() == null;
+    }
+
+    private void completeParallel(LineReader reader, ParsedLine line, Consumer<List<Candidate>> batches) {
+        long timeout = ReaderUtils.getLong(reader, LineReader.COMPLETER_TIMEOUT, LineReaderImpl.DEFAULT_COMPLETER_TIMEOUT);
+        // a single deadline for all the completers, whether they could start or not
+        long deadline = System.nanoTime() + TimeUnit.MILLISECONDS.toNanos(timeout);
+        Executor exec = executor != null ? executor : Pool.EXECUTOR;
+        List<Task> tasks = new ArrayList<>();
+        for (Completer completer : completers) {
+            Task task = new Task(() -> {
+                List<List<Candidate>> result = new ArrayList<>();
+                IN_POOL.set(Boolean.TRUE);
+                try {
+                    completer.completeIncrementally(reader, line, result::add);
+                } finally {
+                    IN_POOL.remove();
+                }
+                return result;
+            });
+            tasks.add(task);
+            try {
+                exec.execute(task);
+            } catch (RejectedExecutionException e) {
+                task.run();
+            }
+        }
+        try {
+            // wait for the completers in order so that the merge is deterministic
+            for (Task task : tasks) {
+                List<List<Candidate>> result;
+                try {
+                    result = task.get(Math.max(0, deadline - System.nanoTime()), TimeUnit.NANOSECONDS);
+                } catch (TimeoutException e) {
+                    if (task.running) {
+                        Log.debug("Completer did not complete within ", timeout, "ms, running for ",
+                                TimeUnit.NANOSECONDS.toMillis(System.nanoTime() - task.started),
+                                "ms, dropping its candidates");
+                    } else {
+                        Log.debug("Completer did not start within ", timeout, "ms, dropping its candidates");
+                    }
+                    continue;
+                } catch (ExecutionException e) {
+                    if (e.getCause() instanceof Error) {
+                        throw (Error) e.getCause();
+                    }
+                    Log.debug("Completer failed, dropping its candidates", e.getCause());
+                    continue;
+                }
+                for (List<Candidate> batch : result) {
+                    batches.accept(batch);
+                }
+            }
+        } catch (InterruptedException e) {
+            Thread.currentThread().interrupt();
+        } finally {
+            for (Task task : tasks) {
+                task.cancel(true);
+            }
+        }
+    }
+
+    /**
+     * A completer run, remembering when it started to run for the logs.
+     */
+    private static class Task extends FutureTask<List<List<Candidate>>> {
+        private volatile boolean running;
+        private volatile long started;
+
+        Task(Callable<List<List<Candidate>>> callable) {
+            super(callable);
+        }
+
+        @Override
+        public void run() {
+            if (!running) {
+                started = System.nanoTime();
+                running = true;
+            }
+            super.run();
+        }
+    }
+
+    private static class Pool {
+        static final Executor EXECUTOR;
+
+        static {
+            int threads = Math.max(2, Runtime.getRuntime().availableProcessors());
+            AtomicInteger counter = new AtomicInteger();
+            ThreadPoolExecutor executor = new ThreadPoolExecutor(threads, threads, 30, TimeUnit.SECONDS,
+                    new LinkedBlockingQueue<>(), r -> {
+                        Thread thread = new Thread(r, "JLine completer-" + counter.incrementAndGet());
+                        thread.setDaemon(true);
+                        return thread;
+                    });
+            executor.allowCoreThreadTimeOut(true);
+            EXECUTOR = executor;
+        }
     }
 
     /**
@@ -9,6 +9,7 @@
 package org.jline.reader.impl.completer;
 
 import java.util.*;
+import java.util.function.Consumer;
 
 import org.jline.reader.Candidate;
 import org.jline.reader.Completer;
@@ -58,6 +59,21 @@ public class SystemCompleter implements Completer {
         }
     }
 
+    @Override
+    public void completeIncrementally(LineReader reader, ParsedLine commandLine, Consumer<List<Candidate>> batches) {
+        if (commandLine.words().size() > 1) {
+            if (!compiled) {
+                throw new IllegalStateException();
+            }
+            String cmd = reader.getParser().getCommand(commandLine.words().get(0));
+            if (command(cmd) != null) {
+                completers.get(command(cmd)).get(0).completeIncrementally(reader, commandLine, batches);
+            }
+        } else {
+            Completer.super.completeIncrementally(reader, commandLine, batches);
+        }
+    }
+
     public boolean isCompiled() {
         return compiled;
     }
@@ -0,0 +1,390 @@
+/*
+ * Copyright (c) 2002-2021, the original author or authors.
+ *
+ * This software is distributable under the BSD license. See the terms of the
+ * BSD license in the documentation provided with this software.
+ *
+ * https://opensource.org/licenses/BSD-3-Clause
+ */
+package org.jline.reader.impl.history;
+
+import java.io.BufferedReader;
+import java.io.ByteArrayOutputStream;
+import java.io.IOException;
+import java.io.OutputStream;
+import java.nio.ByteBuffer;
+import java.nio.channels.FileChannel;
+import java.nio.charset.StandardCharsets;
+import java.nio.file.Files;
+import java.nio.file.Path;
+import java.nio.file.Paths;
+import java.nio.file.StandardOpenOption;
+
+import org.jline.reader.History.Entry;
+
+/**
+ * Binary format of the history files.
+ * <p>
+ * The file starts with a magic number, followed by records holding their
+ * length both before and after their payload, so that the file can be
+ * read forwards as well as backwards from its end:
+ * </p>
+ * <pre>
+ * file    := MAGIC record*
+ * record  := length payload length
+ * entry   := varint(zigzag(epoch millis)) utf-8 line
+ * index   := varint(number of entries before the record)
+ * </pre>
+ * <p>
+ * The length is a 32 bits big endian integer, whose high bit is set for
+ * index records.  An index record precedes every {@value #INDEX_INTERVAL}th
+ * entry, so that the last entries of a file and the number of entries
+ * before them are found by reading a bounded part of the file.  Records
+ * are only ever appended.
+ * </p>
+ */
+public final class BinaryHistoryFile {
+
+    static final byte[] MAGIC = { 0, 'J', 'L', 'H', 1 };
+    static final int INDEX_INTERVAL = 1024;
+
+    private static final int INDEX_FLAG = 0x80000000;
+    private static final int CHUNK_SIZE = 64 * 1024;
+
+    private BinaryHistoryFile() {
+    }
+
+    /**
+     * Checks whether the given file is in the binary format.
+     */
+    static boolean isBinary(FileChannel channel) throws IOException {
+        if (channel.size() < MAGIC.length) {
+            return false;
+        }
+        ByteBuffer buffer = ByteBuffer.allocate(MAGIC.length);
+        while (buffer.hasRemaining()) {
+            if (channel.read(buffer, buffer.position()) < 0) {
+                return false;
+            }
+        }
+        buffer.flip();
+        return buffer.equals(ByteBuffer.wrap(MAGIC));
+    }
+
+    static boolean isBinary(byte[] data) {
+        if (data.length < MAGIC.length) {
+            return false;
+        }
+        for (int i = 0; i < MAGIC.length; i++) {
+            if (data[i] != MAGIC[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static boolean isBinary(Path path) throws IOException {
+        if (!Files.exists(path)) {
+            return false;
+        }
+        try (FileChannel channel = FileChannel.open(path, StandardOpenOption.READ)) {
+            return isBinary(channel);
+        }
+    }
+
+    /**
+     * Finds the first of the <code>max</code> last entries of a binary file.
+     * The file is read backwards up to the closest index record.
+     * @return the position of the entry and the number of entries before it
+     */
+    static long[] tail(FileChannel channel, long size, int max) throws IOException {
+        Window window = new Window(channel, size);
+        boolean located = false;
+        long start = size;
+        int kept = 0;
+        int found = 0;
+        long pos = size;
+        while (pos > MAGIC.length) {
+            if (found == max && !located) {
+                located = true;
+                start = pos;
+                kept = found;
+            }
+            int length = window.getInt(pos - 4);
+            long from = pos - 8 - (length & ~INDEX_FLAG);
+            if (from < MAGIC.length || window.getInt(from) != length) {
+                throw corrupted();
+            }
+            if ((length & INDEX_FLAG) != 0) {
+                if (found >= max) {
+                    long count = window.getVarint(from + 4) + found - kept;
+                    return new long[] { start, count };
+                }
+            } else {
+                found++;
+            }
+            pos = from;
+        }
+        if (found <= max) {
+            return new long[] { MAGIC.length, 0 };
+        }
+        return new long[] { start, found - kept };
+    }
+
+    /**
+     * Number of entries in a binary file.
+     */
+    static int count(FileChannel channel, long size) throws IOException {
+        return (int) tail(channel, size, 0)[1];
+    }
+
+    /**
+     * Encodes the given entries to be appended to a file.
+     * @param count the number of entries already in the file, or -1 for a new file
+     */
+    static byte[] encode(Iterable<Entry> entries, int count) {
+        ByteArrayOutputStream out = new ByteArrayOutputStream();
+        if (count < 0) {
+            out.write(MAGIC, 0, MAGIC.length);
+            count = 0;
+        }
+        ByteArrayOutputStream payload = new ByteArrayOutputStream();
+        for (Entry entry : entries) {
+            writeEntry(out, payload, count++, entry.time().toEpochMilli(), entry.line());
+        }
+        return out.toByteArray();
+    }
+
+    /**
+     * Writes an entry, preceded by an index record when needed.
+     * @param count the number of entries before this one
+     */
+    private static void writeEntry(ByteArrayOutputStream out, ByteArrayOutputStream payload,
+                                   int count, long millis, String line) {
+        if (count > 0 && count % INDEX_INTERVAL == 0) {
+            payload.reset();
+            writeVarint(payload, count);
+            writeRecord(out, payload, INDEX_FLAG);
+        }
+        payload.reset();
+        writeVarint(payload, (millis << 1) ^ (millis >> 63));
+        byte[] bytes = line.getBytes(StandardCharsets.UTF_8);
+        payload.write(bytes, 0, bytes.length);
+        writeRecord(out, payload, 0);
+    }
+
+    private static void writeRecord(ByteArrayOutputStream out, ByteArrayOutputStream payload, int flag) {
+        int length = payload.size() | flag;
+        writeInt(out, length);
+        out.write(payload.toByteArray(), 0, payload.size());
+        writeInt(out, length);
+    }
+
+    private static void writeInt(ByteArrayOutputStream out, int value) {
+        out.write(value >>> 24);
+        out.write(value >>> 16);
+        out.write(value >>> 8);
+        out.write(value);
+    }
+
+    private static void writeVarint(ByteArrayOutputStream out, long value) {
+        while ((value & ~0x7FL) != 0) {
+            out.write((int) (value & 0x7F) | 0x80);
+            value >>>= 7;
+        }
+        out.write((int) value);
+    }
+
+    /**
+     * The entries of a part of a binary file, which starts at a record.
+     */
+    static final class Records {
+
+        private final byte[] data;
+        private int pos;
+        private long millis;
+        private int start;
+        private int end;
+
+        Records(byte[] data, int pos) {
+            this.data = data;
+            this.pos = pos;
+        }
+
+        /**
+         * Moves to the next entry, skipping the index records.
+         * @return <code>false</code> when there are no more entries
+         */
+        boolean next() throws IOException {
+            while (pos < data.length) {
+                if (data.length - pos < 8) {
+                    throw corrupted();
+                }
+                int length = getInt(data, pos);
+                int size = length & ~INDEX_FLAG;
+                if (size > data.length - pos - 8 || getInt(data, pos + 4 + size) != length) {
+                    throw corrupted();
+                }
+                int from = pos + 4;
+                pos += size + 8;
+                if ((length & INDEX_FLAG) == 0) {
+                    long zigzag = 0;
+                    int shift = 0;
+                    int i = from;
+                    int b;
+                    do {
+                        if (i == from + size || shift > 63) {
+                            throw corrupted();
+                        }
+                        b = data[i++];
+                        zigzag |= (long) (b & 0x7F) << shift;
+                        shift += 7;
+                    } while ((b & 0x80) != 0);
+                    millis = (zigzag >>> 1) ^ -(zigzag & 1);
+                    start = i;
+                    end = from + size;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        long millis() {
+            return millis;
+        }
+
+        /**
+         * Position of the UTF-8 encoded line of the current entry.
+         */
+        int start() {
+            return start;
+        }
+
+        int end() {
+            return end;
+        }
+
+        String line() {
+            return new String(data, start, end - start, StandardCharsets.UTF_8);
+        }
+    }
+
+    /**
+     * Converts a text history file to the binary format.
+     * @param source the text history file
+     * @param target the binary history file to create
+     * @param timestamped whether the lines of the text file are prefixed by their time,
+     *                    otherwise the entries get the time of the last change of the file
+     */
+    public static void convert(Path source, Path target, boolean timestamped) throws IOException {
+        long modified = Files.getLastModifiedTime(source).toMillis();
+        try (BufferedReader reader = Files.newBufferedReader(source);
+             OutputStream out = Files.newOutputStream(target)) {
+            ByteArrayOutputStream payload = new ByteArrayOutputStream();
+            ByteArrayOutputStream buffer = new ByteArrayOutputStream();
+            buffer.write(MAGIC, 0, MAGIC.length);
+            int count = 0;
+            String line;
+            while ((line = reader.readLine()) != null) {
+                long millis = modified;
+                if (timestamped) {
+                    int idx = line.indexOf(':');
+                    try {
+                        millis = Long.parseLong(line.substring(0, Math.max(idx, 0)));
+                    } catch (NumberFormatException e) {
+                        throw new IOException("Bad history file syntax: " + source);
+                    }
+                    line = line.substring(idx + 1);
+                }
+                writeEntry(buffer, payload, count++, millis, DefaultHistory.unescape(line));
+                if (buffer.size() >= CHUNK_SIZE) {
+                    buffer.writeTo(out);
+                    buffer.reset();
+                }
+            }
+            buffer.writeTo(out);
+        }
+    }
+
+    /**
+     * Converts a text history file to the binary format.
+     * <pre>
+     * BinaryHistoryFile [-t] source target
+     * </pre>
+     * The <code>-t</code> option indicates a timestamped history file.
+     */
+    public static void main(String[] args) throws IOException {
+        boolean timestamped = args.length == 3 && args[0].equals("-t");
+        if (args.length != (timestamped ? 3 : 2)) {
+            System.err.println("usage: BinaryHistoryFile [-t] source target");
+            System.exit(1);
+        }
+        int i = timestamped ? 1 : 0;
+        convert(Paths.get(args[i]), Paths.get(args[i + 1]), timestamped);
+    }
+
+    private static IOException corrupted() {
+        return new IOException("Corrupted binary history file");
+    }
+
+    private static int getInt(byte[] data, int pos) {
+        return (data[pos] & 0xFF) << 24 | (data[pos + 1] & 0xFF) << 16
+                | (data[pos + 2] & 0xFF) << 8 | (data[pos + 3] & 0xFF);
+    }
+
+    /**
+     * A part of a file, read by chunks when reading backwards.
+     */
+    private static class Window {
+
+        private final FileChannel channel;
+        private final long size;
+        private final ByteBuffer buffer = ByteBuffer.allocate(CHUNK_SIZE);
+        private long position = -1;
+
+        Window(FileChannel channel, long size) {
+            this.channel = channel;
+            this.size = size;
+        }
+
+        int getInt(long pos) throws IOException {
+            int i = ensure(pos, 4);
+            return buffer.getInt(i);
+        }
+
+        long getVarint(long pos) throws IOException {
+            int i = ensure(pos, 10);
+            long value = 0;
+            int shift = 0;
+            int b;
+            do {
+                if (i == buffer.limit() || shift > 63) {
+                    throw corrupted();
+                }
+                b = buffer.get(i++);
+                value |= (long) (b & 0x7F) << shift;
+                shift += 7;
+            } while ((b & 0x80) != 0);
+            return value;
+        }
+
+        /**
+         * Reads the chunk ending after the given bytes, unless already read.
+         * @return the index of the bytes in the buffer
+         */
+        private int ensure(long pos, int length) throws IOException {
+            long end = Math.min(pos + length, size);
+            if (position < 0 || pos < position || end > position + buffer.limit()) {
+                position = Math.max(0, end - CHUNK_SIZE);
+                buffer.clear();
+                buffer.limit((int) (end - position));
+                while (buffer.hasRemaining()) {
+                    if (channel.read(buffer, position + buffer.position()) < 0) {
+                        throw corrupted();
+                    }
+                }
+            }
+            return (int) (pos - position);
+        }
+    }
+}
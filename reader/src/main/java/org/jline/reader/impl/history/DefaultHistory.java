@@ -9,10 +9,16 @@
 package org.jline.reader.impl.history;
 
 import java.io.*;
+import java.nio.ByteBuffer;
+import java.nio.channels.FileChannel;
+import java.nio.channels.FileLock;
+import java.nio.charset.StandardCharsets;
 import java.nio.file.*;
 import java.time.DateTimeException;
 import java.time.Instant;
 import java.util.*;
+import java.util.concurrent.ConcurrentHashMap;
+import java.util.concurrent.locks.ReentrantLock;
 
 import org.jline.reader.History;
 import org.jline.reader.LineReader;
@@ -27,20 +33,45 @@ import static org.jline.reader.impl.ReaderUtils.*;
  * Implementers should install shutdown hook to call {@link DefaultHistory#save}
  * to save history to disk.
  * </p>
+ * <p>
+ * The entries loaded from the history file when attaching to a reader, or
+ * by {@link #load()}, are decoded lazily and do not go through
+ * {@link #addHistoryLine(Path, String)} nor {@link #internalAdd(Instant, String)}.
+ * Subclasses keeping track of the entries should override
+ * {@link #entryAdded(Entry)}, which is called for every entry.
+ * </p>
  */
 public class DefaultHistory implements History {
 
     public static final int DEFAULT_HISTORY_SIZE = 500;
     public static final int DEFAULT_HISTORY_FILE_SIZE = 10000;
 
-    private final LinkedList<Entry> items = new LinkedList<>();
+    private static final int CHUNK_SIZE = 64 * 1024;
+    private static final int MARK_SIZE = 64;
+
+    private final EntryRing items = new EntryRing();
 
     private LineReader reader;
 
+    /*
+     * Maximum number of entries, read from the reader when attached, and at
+     * the start of each public operation, rather than for each entry added
+     * or evicted while loading.
+     */
+    private int historySize = DEFAULT_HISTORY_SIZE;
+
     private Map<String, HistoryFileData> historyFiles = new HashMap<>();
     private int offset = 0;
     private int index = 0;
 
+    /*
+     * Occurrences of each trimmed line, used to detect duplicates.
+     * Lazily computed and only maintained once duplicates have been checked.
+     */
+    private Map<String, Integer> lineCounts;
+    // version of the entries the counts are up to date with
+    private int countedVersion;
+
     public DefaultHistory() {
     }
 
@@ -76,17 +107,23 @@ public class DefaultHistory implements History {
 
     @Override
     public void load() throws IOException {
+        updateHistorySize();
         Path path = getPath();
         if (path != null) {
             try {
                 if (Files.exists(path)) {
                     Log.trace("Loading history from: ", path);
-                    try (BufferedReader reader = Files.newBufferedReader(path)) {
-                        internalClear();
-                        reader.lines().forEach(line -> addHistoryLine(path, line));
-                        setHistoryFileData(path, new HistoryFileData(items.size(), offset + items.size()));
-                        maybeResize();
+                    internalClear();
+                    if (isSet(reader, LineReader.Option.HISTORY_SHARED)) {
+                        try (SharedFile file = new SharedFile(path)) {
+                            HistoryFileData data = readTail(path, file.channel);
+                            file.mark(data, data.position);
+                            setHistoryFileData(path, data);
+                        }
+                    } else {
+                        setHistoryFileData(path, readTail(path));
                     }
+                    maybeResize();
                 }
             } catch (IllegalArgumentException | IOException e) {
                 Log.debug("Failed to load history; clearing", e);
@@ -103,11 +140,24 @@ public class DefaultHistory implements History {
             try {
                 if (Files.exists(path)) {
                     Log.trace("Reading history from: ", path);
-                    try (BufferedReader reader = Files.newBufferedReader(path)) {
-                        reader.lines().forEach(line -> addHistoryLine(path, line, incremental));
+                    updateHistorySize();
+                    if (incremental && BinaryHistoryFile.isBinary(path)) {
+                        BinaryHistoryFile.Records records = new BinaryHistoryFile.Records(
+                                Files.readAllBytes(path), BinaryHistoryFile.MAGIC.length);
+                        while (records.next()) {
+                            internalAdd(Instant.ofEpochMilli(records.millis()), records.line(), true);
+                        }
                         setHistoryFileData(path, new HistoryFileData(items.size(), offset + items.size()));
-                        maybeResize();
+                    } else if (incremental) {
+                        // duplicates are checked against every line, so read them all
+                        try (BufferedReader reader = Files.newBufferedReader(path)) {
+                            reader.lines().forEach(line -> addHistoryLine(path, line, true));
+                        }
+                        setHistoryFileData(path, new HistoryFileData(items.size(), offset + items.size()));
+                    } else {
+                        setHistoryFileData(path, readTail(path));
                     }
+                    maybeResize();
                 }
             } catch (IllegalArgumentException | IOException e) {
                 Log.debug("Failed to read history; clearing", e);
@@ -117,6 +167,152 @@ public class DefaultHistory implements History {
         }
     }
 
+    /**
+     * Appends the last lines of the given file to the history.
+     * <p>
+     * Only the tail of the file which can fit in the history is read,
+     * scanning backwards from the end of the file: the lines before are
+     * only counted, so that the entries are numbered from the start of the file.
+     * The kept lines are decoded lazily, when the entries are first accessed.
+     * Binary files are only read up to the closest index record, which gives
+     * the number of entries before.
+     * </p>
+     * @return the data of the file, positioned at its end
+     */
+    private HistoryFileData readTail(Path path) throws IOException {
+        try (FileChannel channel = FileChannel.open(path, StandardOpenOption.READ)) {
+            return readTail(path, channel);
+        }
+    }
+
+    private HistoryFileData readTail(Path path, FileChannel channel) throws IOException {
+        int max = historySize;
+        long size = channel.size();
+        boolean binary = BinaryHistoryFile.isBinary(channel);
+        long start;
+        int skipped = 0;
+        if (binary) {
+            long[] t = BinaryHistoryFile.tail(channel, size, max);
+            start = t[0];
+            skipped = (int) t[1];
+        } else {
+            start = tailStart(channel, size, max);
+            skipped = countLines(channel, start);
+        }
+        if (size - start > Integer.MAX_VALUE - 8) {
+            throw new IOException("History file too large: " + path);
+        }
+        byte[] tail = new byte[(int) (size - start)];
+        readFully(channel, ByteBuffer.wrap(tail), start);
+        // The skipped lines would have been evicted right away
+        offset += skipped;
+        for (HistoryFileData hfd : historyFiles.values()) {
+            hfd.decLastLoaded(skipped);
+        }
+        if (binary) {
+            appendRecords(tail, 0);
+        } else {
+            appendLines(path, tail);
+        }
+        HistoryFileData data = new HistoryFileData(items.size(), offset + items.size());
+        data.position = size;
+        return data;
+    }
+
+    /**
+     * Appends the entries of a binary history file contained in the given bytes,
+     * starting at the given record, to the history.
+     * @return the number of entries
+     */
+    private int appendRecords(byte[] bytes, int from) throws IOException {
+        BinaryHistoryFile.Records records = new BinaryHistoryFile.Records(bytes, from);
+        int entries = 0;
+        while (records.next()) {
+            appendEntry(LazyEntry.create(offset + items.size(), bytes, records));
+            entries++;
+        }
+        return entries;
+    }
+
+    /**
+     * Appends the lines contained in the given bytes to the history.
+     * @return the number of lines
+     */
+    private int appendLines(Path path, byte[] bytes) {
+        boolean timestamped = reader.isSet(LineReader.Option.HISTORY_TIMESTAMPED);
+        Instant now = Instant.now();
+        int lines = 0;
+        int from = 0;
+        while (from < bytes.length) {
+            int to = from;
+            while (to < bytes.length && bytes[to] != '\n') {
+                to++;
+            }
+            int end = to > from && bytes[to - 1] == '\r' ? to - 1 : to;
+            appendEntry(LazyEntry.create(path, offset + items.size(), bytes, from, end, timestamped, now));
+            lines++;
+            from = to + 1;
+        }
+        return lines;
+    }
+
+    /**
+     * Position of the first of the <code>max</code> last lines of the file.
+     */
+    private static long tailStart(FileChannel channel, long size, int max) throws IOException {
+        if (max <= 0) {
+            return size;
+        }
+        ByteBuffer buffer = ByteBuffer.allocate((int) Math.min(CHUNK_SIZE, size));
+        int found = 0;
+        long pos = size;
+        while (pos > 0) {
+            int len = (int) Math.min(CHUNK_SIZE, pos);
+            pos -= len;
+            buffer.clear();
+            buffer.limit(len);
+            readFully(channel, buffer, pos);
+            for (int i = len - 1; i >= 0; i--) {
+                // a trailing new line terminates the last line
+                if (buffer.get(i) == '\n' && pos + i != size - 1 && ++found == max) {
+                    return pos + i + 1;
+                }
+            }
+        }
+        return 0;
+    }
+
+    /**
+     * Number of lines before the given position, which follows a new line.
+     */
+    private static int countLines(FileChannel channel, long end) throws IOException {
+        ByteBuffer buffer = ByteBuffer.allocate((int) Math.min(CHUNK_SIZE, end));
+        int lines = 0;
+        long pos = 0;
+        while (pos < end) {
+            int len = (int) Math.min(CHUNK_SIZE, end - pos);
+            buffer.clear();
+            buffer.limit(len);
+            readFully(channel, buffer, pos);
+            for (int i = 0; i < len; i++) {
+                if (buffer.get(i) == '\n') {
+                    lines++;
+                }
+            }
+            pos += len;
+        }
+        return lines;
+    }
+
+    private static void readFully(FileChannel channel, ByteBuffer buffer, long pos) throws IOException {
+        long start = pos - buffer.position();
+        while (buffer.hasRemaining()) {
+            if (channel.read(buffer, start + buffer.position()) < 0) {
+                throw new EOFException("History file truncated while reading");
+            }
+        }
+    }
+
     private String doHistoryFileDataKey (Path path){
         return path != null ? path.toAbsolutePath().toString() : null;
     }
@@ -168,17 +364,14 @@ public class DefaultHistory implements History {
     protected void addHistoryLine(Path path, String line, boolean checkDuplicates) {
         if (reader.isSet(LineReader.Option.HISTORY_TIMESTAMPED)) {
             int idx = line.indexOf(':');
-            final String badHistoryFileSyntax = "Bad history file syntax! " +
-                "The history file `" + path + "` may be an older history: " +
-                "please remove it or use a different history file.";
             if (idx < 0) {
-                throw new IllegalArgumentException(badHistoryFileSyntax);
+                throw new IllegalArgumentException(badHistoryFileSyntax(path));
             }
             Instant time;
             try {
                 time = Instant.ofEpochMilli(Long.parseLong(line.substring(0, idx)));
             } catch (DateTimeException | NumberFormatException e) {
-                throw new IllegalArgumentException(badHistoryFileSyntax);
+                throw new IllegalArgumentException(badHistoryFileSyntax(path));
             }
 
             String unescaped = unescape(line.substring(idx + 1));
@@ -189,6 +382,12 @@ public class DefaultHistory implements History {
         }
     }
 
+    private static String badHistoryFileSyntax(Path path) {
+        return "Bad history file syntax! " +
+            "The history file `" + path + "` may be an older history: " +
+            "please remove it or use a different history file.";
+    }
+
     @Override
     public void purge() throws IOException {
         internalClear();
@@ -216,22 +415,139 @@ public class DefaultHistory implements History {
 
     @Override
     public void save() throws IOException {
-        internalWrite(getPath(), getLastLoaded(getPath()));
+        Path path = getPath();
+        if (path != null && isSet(reader, LineReader.Option.HISTORY_SHARED)) {
+            sharedWrite(path);
+        } else {
+            internalWrite(path, getLastLoaded(path));
+        }
+    }
+
+    /**
+     * Appends the new entries to a history file shared with other sessions.
+     * <p>
+     * While holding the lock on the file, the entries appended by the other
+     * sessions since the last write are imported before the new ones, which
+     * are then appended with a single write.  If the file has been compacted
+     * in the meantime, the history is reloaded from it instead.
+     * </p>
+     */
+    private void sharedWrite(Path path) throws IOException {
+        Log.trace("Saving shared history to: ", path);
+        Path parent = path.toAbsolutePath().getParent();
+        if (!Files.exists(parent)) {
+            Files.createDirectories(parent);
+        }
+        updateHistorySize();
+        try (SharedFile file = new SharedFile(path)) {
+            HistoryFileData data = getHistoryFileData(path);
+            int from = Math.min(data.getLastLoaded(), items.size());
+            List<Entry> unsaved = new ArrayList<>(items.subList(from, items.size()));
+            long size = file.size();
+            boolean compacted = size < data.position || !file.isMarked(data);
+            if (compacted || size > data.position) {
+                // the new entries go after the imported ones
+                ListIterator<Entry> it = iterator(offset + from);
+                while (it.hasNext()) {
+                    it.next();
+                    it.remove();
+                }
+                if (compacted) {
+                    Log.trace("Reloading compacted history: ", path);
+                    internalClear();
+                    data = readTail(path, file.channel);
+                    setHistoryFileData(path, data);
+                } else if (file.isBinary()) {
+                    // skip the magic number of a file created by another session
+                    int start = data.position == 0 ? BinaryHistoryFile.MAGIC.length : 0;
+                    data.incEntriesInFile(appendRecords(file.read(data.position, size), start));
+                } else {
+                    data.incEntriesInFile(appendLines(path, file.read(data.position, size)));
+                }
+                for (Entry entry : unsaved) {
+                    internalAdd(entry.time(), entry.line());
+                }
+            }
+            List<Entry> persisted = new ArrayList<>();
+            for (Entry entry : unsaved) {
+                if (isPersistable(entry)) {
+                    persisted.add(entry);
+                }
+            }
+            if (file.size() == 0 ? isSet(reader, LineReader.Option.HISTORY_BINARY) : file.isBinary()) {
+                file.append(BinaryHistoryFile.encode(persisted, file.size() == 0 ? -1 : file.count()));
+            } else {
+                file.append(format(persisted).getBytes(StandardCharsets.UTF_8));
+            }
+            data.incEntriesInFile(persisted.size());
+            data.setLastLoaded(items.size());
+            file.mark(data, file.size());
+            int max = getInt(reader, LineReader.HISTORY_FILE_SIZE, DEFAULT_HISTORY_FILE_SIZE);
+            if (data.getEntriesInFile() > max + max / 4) {
+                compact(path, file, max);
+            }
+        }
+    }
+
+    /**
+     * Trims a shared history file while holding its lock.  The file is
+     * rewritten in place rather than replaced, so that the other sessions
+     * keep locking the same file.
+     */
+    private void compact(Path path, SharedFile file, int max) throws IOException {
+        Log.trace("Compacting history path: ", path);
+        List<Entry> allItems = loadEntries(file.read(0, file.size()));
+        if (allItems.isEmpty()) {
+            return;
+        }
+        List<Entry> trimmedItems = doTrimHistory(allItems, max);
+        byte[] bytes = file.isBinary()
+                ? BinaryHistoryFile.encode(trimmedItems, -1)
+                : format(trimmedItems).getBytes(StandardCharsets.UTF_8);
+        file.overwrite(bytes);
+        internalClear();
+        offset = trimmedItems.get(0).index();
+        items.addAll(trimmedItems);
+        trimmedItems.forEach(this::entryAdded);
+        HistoryFileData data = new HistoryFileData(items.size(), items.size());
+        file.mark(data, file.size());
+        setHistoryFileData(path, data);
+        maybeResize();
     }
 
     private void internalWrite(Path path, int from) throws IOException {
         if (path != null) {
             Log.trace("Saving history to: ", path);
+            updateHistorySize();
             Path parent = path.toAbsolutePath().getParent();
             if (!Files.exists(parent)) {
                 Files.createDirectories(parent);
             }
             // Append new items to the history file
-            try (BufferedWriter writer = Files.newBufferedWriter(path.toAbsolutePath(),
-              StandardOpenOption.WRITE, StandardOpenOption.APPEND, StandardOpenOption.CREATE)) {
+            if (isBinary(path)) {
+                List<Entry> persisted = new ArrayList<>();
                 for (Entry entry : items.subList(from, items.size())) {
                     if (isPersistable(entry)) {
-                        writer.append(format(entry));
+                        persisted.add(entry);
+                    }
+                }
+                // the entries are counted from the file, so it is read as well as appended to
+                try (FileChannel channel = FileChannel.open(path.toAbsolutePath(),
+                        StandardOpenOption.READ, StandardOpenOption.WRITE, StandardOpenOption.CREATE)) {
+                    long size = channel.size();
+                    ByteBuffer buffer = ByteBuffer.wrap(BinaryHistoryFile.encode(persisted,
+                            size == 0 ? -1 : BinaryHistoryFile.count(channel, size)));
+                    while (buffer.hasRemaining()) {
+                        channel.write(buffer, size + buffer.position());
+                    }
+                }
+            } else {
+                try (BufferedWriter writer = Files.newBufferedWriter(path.toAbsolutePath(),
+                  StandardOpenOption.WRITE, StandardOpenOption.APPEND, StandardOpenOption.CREATE)) {
+                    for (Entry entry : items.subList(from, items.size())) {
+                        if (isPersistable(entry)) {
+                            writer.append(format(entry));
+                        }
                     }
                 }
             }
@@ -246,23 +562,17 @@ public class DefaultHistory implements History {
 
     protected void trimHistory(Path path, int max) throws IOException {
         Log.trace("Trimming history path: ", path);
-        // Load all history entries
-        LinkedList<Entry> allItems = new LinkedList<>();
-        try (BufferedReader reader = Files.newBufferedReader(path)) {
-            reader.lines().forEach(l -> {
-                int idx = l.indexOf(':');
-                Instant time = Instant.ofEpochMilli(Long.parseLong(l.substring(0, idx)));
-                String line = unescape(l.substring(idx + 1));
-                allItems.add(createEntry(allItems.size(), time, line));
-            });
-        }
         // Remove duplicates
-        List<Entry> trimmedItems = doTrimHistory(allItems, max);
+        List<Entry> trimmedItems = doTrimHistory(loadEntries(path), max);
         // Write history
         Path temp = Files.createTempFile(path.toAbsolutePath().getParent(), path.getFileName().toString(), ".tmp");
-        try (BufferedWriter writer = Files.newBufferedWriter(temp, StandardOpenOption.WRITE)) {
-            for (Entry entry : trimmedItems) {
-                writer.append(format(entry));
+        if (BinaryHistoryFile.isBinary(path)) {
+            Files.write(temp, BinaryHistoryFile.encode(trimmedItems, -1));
+        } else {
+            try (BufferedWriter writer = Files.newBufferedWriter(temp, StandardOpenOption.WRITE)) {
+                for (Entry entry : trimmedItems) {
+                    writer.append(format(entry));
+                }
             }
         }
         Files.move(temp, path, StandardCopyOption.REPLACE_EXISTING);
@@ -271,13 +581,41 @@ public class DefaultHistory implements History {
             internalClear();
             offset = trimmedItems.get(0).index();
             items.addAll(trimmedItems);
+            trimmedItems.forEach(this::entryAdded);
             setHistoryFileData(path, new HistoryFileData(items.size(), items.size()));
         } else {
-            setEntriesInFile(path, allItems.size());
+            setEntriesInFile(path, trimmedItems.size());
         }
         maybeResize();
     }
 
+    /**
+     * Load all the entries of a timestamped history file.
+     */
+    private List<Entry> loadEntries(Path path) throws IOException {
+        return loadEntries(Files.readAllBytes(path));
+    }
+
+    private List<Entry> loadEntries(byte[] bytes) throws IOException {
+        LinkedList<Entry> allItems = new LinkedList<>();
+        if (BinaryHistoryFile.isBinary(bytes)) {
+            BinaryHistoryFile.Records records = new BinaryHistoryFile.Records(bytes, BinaryHistoryFile.MAGIC.length);
+            while (records.next()) {
+                allItems.add(createEntry(allItems.size(), Instant.ofEpochMilli(records.millis()), records.line()));
+            }
+            return allItems;
+        }
+        try (BufferedReader reader = new BufferedReader(new StringReader(new String(bytes, StandardCharsets.UTF_8)))) {
+            reader.lines().forEach(l -> {
+                int idx = l.indexOf(':');
+                Instant time = Instant.ofEpochMilli(Long.parseLong(l.substring(0, idx)));
+                String line = unescape(l.substring(idx + 1));
+                allItems.add(createEntry(allItems.size(), time, line));
+            });
+        }
+        return allItems;
+    }
+
     /**
      * Create a history entry. Subclasses may override to use their own entry implementations.
      * @param index index of history entry
@@ -294,28 +632,46 @@ public class DefaultHistory implements History {
         index = 0;
         historyFiles = new HashMap<>();
         items.clear();
+        lineCounts = null;
+        entriesCleared();
+    }
+
+    /**
+     * Called after an entry has been appended to the history.
+     * Subclasses may override to maintain additional data structures.
+     * @param entry the new entry
+     */
+    protected void entryAdded(Entry entry) {
+    }
+
+    /**
+     * Called after the oldest entry has been evicted from the history.
+     * @param entry the removed entry
+     */
+    protected void entryRemoved(Entry entry) {
+    }
+
+    /**
+     * Called after all entries have been removed from the history.
+     */
+    protected void entriesCleared() {
     }
 
     static List<Entry> doTrimHistory(List<Entry> allItems, int max) {
-        int idx = 0;
-        while (idx < allItems.size()) {
-            int ridx = allItems.size() - idx - 1;
-            String line = allItems.get(ridx).line().trim();
-            ListIterator<Entry> iterator = allItems.listIterator(ridx);
-            while (iterator.hasPrevious()) {
-                String l = iterator.previous().line();
-                if (line.equals(l.trim())) {
-                    iterator.remove();
-                }
+        // Walk backwards so that the last occurrence of duplicates wins,
+        // stopping once enough entries have been kept
+        Set<String> lines = new HashSet<>();
+        Deque<Entry> kept = new ArrayDeque<>();
+        ListIterator<Entry> iterator = allItems.listIterator(allItems.size());
+        while (iterator.hasPrevious() && kept.size() < max) {
+            Entry e = iterator.previous();
+            if (lines.add(e.line().trim())) {
+                kept.addFirst(e);
             }
-            idx++;
         }
-        while (allItems.size() > max) {
-            allItems.remove(0);
-        }
-        int index = allItems.get(allItems.size() - 1).index() - allItems.size() + 1;
-        List<Entry> out = new ArrayList<>();
-        for (Entry e : allItems) {
+        int index = allItems.get(allItems.size() - 1).index() - kept.size() + 1;
+        List<Entry> out = new ArrayList<>(kept.size());
+        for (Entry e : kept) {
             out.add(new EntryImpl(index++, e.time(), e.line()));
         }
         return out;
@@ -341,6 +697,25 @@ public class DefaultHistory implements History {
         return offset + items.size() - 1;
     }
 
+    /**
+     * Checks whether the given history file is in the binary format, or will
+     * be created in this format.
+     */
+    private boolean isBinary(Path path) throws IOException {
+        if (Files.exists(path) && Files.size(path) > 0) {
+            return BinaryHistoryFile.isBinary(path);
+        }
+        return isSet(reader, LineReader.Option.HISTORY_BINARY);
+    }
+
+    private String format(List<Entry> entries) {
+        StringBuilder sb = new StringBuilder();
+        for (Entry entry : entries) {
+            sb.append(format(entry));
+        }
+        return sb.toString();
+    }
+
     private String format(Entry entry) {
         if (reader.isSet(LineReader.Option.HISTORY_TIMESTAMPED)) {
             return entry.time().toEpochMilli() + ":" + escape(entry.line()) + "\n";
@@ -378,6 +753,7 @@ public class DefaultHistory implements History {
         if (matchPatterns(getString(reader, HISTORY_IGNORE, ""), line)) {
             return;
         }
+        updateHistorySize();
         internalAdd(time, line);
         if (isSet(reader, LineReader.Option.HISTORY_INCREMENTAL)) {
             try {
@@ -417,19 +793,45 @@ public class DefaultHistory implements History {
     protected void internalAdd(Instant time, String line, boolean checkDuplicates) {
         Entry entry = new EntryImpl(offset + items.size(), time, line);
         if (checkDuplicates) {
-            for (Entry e: items) {
-                if (e.line().trim().equals(line.trim())) {
-                    return;
+            if (lineCounts == null || countedVersion != items.version()) {
+                // first use, or entries have been changed through an iterator
+                lineCounts = new HashMap<>();
+                for (Entry e : items) {
+                    lineCounts.merge(e.line().trim(), 1, Integer::sum);
                 }
+                countedVersion = items.version();
+            }
+            if (lineCounts.containsKey(line.trim())) {
+                return;
             }
         }
+        appendEntry(entry);
+    }
+
+    private void appendEntry(Entry entry) {
+        boolean counted = lineCounts != null && countedVersion == items.version();
         items.add(entry);
+        if (counted) {
+            lineCounts.merge(entry.line().trim(), 1, Integer::sum);
+            countedVersion = items.version();
+        }
+        entryAdded(entry);
         maybeResize();
     }
 
+    private void updateHistorySize() {
+        historySize = getInt(reader, LineReader.HISTORY_SIZE, DEFAULT_HISTORY_SIZE);
+    }
+
     private void maybeResize() {
-        while (size() > getInt(reader, LineReader.HISTORY_SIZE, DEFAULT_HISTORY_SIZE)) {
-            items.removeFirst();
+        while (size() > historySize) {
+            boolean counted = lineCounts != null && countedVersion == items.version();
+            Entry removed = items.removeFirst();
+            if (counted) {
+                lineCounts.computeIfPresent(removed.line().trim(), (l, c) -> c > 1 ? c - 1 : null);
+                countedVersion = items.version();
+            }
+            entryRemoved(removed);
             for (HistoryFileData hfd: historyFiles.values()) {
                 hfd.decLastLoaded();
             }
@@ -451,15 +853,127 @@ public class DefaultHistory implements History {
         index = Math.min(index, items.size());
     }
 
+    /**
+     * Entries kept in a circular array, giving constant time access by
+     * index and eviction of the oldest entry.  Entries can be inserted or
+     * removed anywhere through the {@link List} interface, at the cost of
+     * moving the entries which follow.
+     */
+    private static class EntryRing extends AbstractList<Entry> implements RandomAccess {
+
+        private Entry[] entries = new Entry[16];
+        private int head;
+        private int size;
+        // bumped on every change, including the entries replaced,
+        // unlike modCount which only tracks structural changes
+        private int version;
+
+        @Override
+        public int size() {
+            return size;
+        }
+
+        @Override
+        public Entry get(int index) {
+            checkIndex(index, size);
+            return entries[slot(index)];
+        }
+
+        @Override
+        public Entry set(int index, Entry entry) {
+            checkIndex(index, size);
+            int slot = slot(index);
+            Entry old = entries[slot];
+            entries[slot] = entry;
+            version++;
+            return old;
+        }
+
+        @Override
+        public void add(int index, Entry entry) {
+            checkIndex(index, size + 1);
+            if (size == entries.length) {
+                Entry[] grown = new Entry[entries.length * 2];
+                for (int i = 0; i < size; i++) {
+                    grown[i] = entries[slot(i)];
+                }
+                entries = grown;
+                head = 0;
+            }
+            for (int i = size; i > index; i--) {
+                entries[slot(i)] = entries[slot(i - 1)];
+            }
+            entries[slot(index)] = entry;
+            size++;
+            modCount++;
+            version++;
+        }
+
+        @Override
+        public Entry remove(int index) {
+            checkIndex(index, size);
+            Entry old = entries[slot(index)];
+            if (index == 0) {
+                entries[head] = null;
+                head = slot(1);
+            } else {
+                for (int i = index; i < size - 1; i++) {
+                    entries[slot(i)] = entries[slot(i + 1)];
+                }
+                entries[slot(size - 1)] = null;
+            }
+            size--;
+            modCount++;
+            version++;
+            return old;
+        }
+
+        @Override
+        public void clear() {
+            Arrays.fill(entries, null);
+            head = 0;
+            size = 0;
+            modCount++;
+            version++;
+        }
+
+        int version() {
+            return version;
+        }
+
+        Entry getLast() {
+            return get(size - 1);
+        }
+
+        Entry removeFirst() {
+            return remove(0);
+        }
+
+        /**
+         * The capacity is a power of two, so that the index wraps with a mask.
+         */
+        private int slot(int index) {
+            return (head + index) & (entries.length - 1);
+        }
+
+        private static void checkIndex(int index, int size) {
+            if (index < 0 || index >= size) {
+                throw new IndexOutOfBoundsException("Index: " + index + ", Size: " + size);
+            }
+        }
+    }
+
     protected static class EntryImpl implements Entry {
 
         private final int index;
-        private final Instant time;
+        private final long seconds;
+        private final int nanos;
         private final String line;
 
         public EntryImpl(int index, Instant time, String line) {
             this.index = index;
-            this.time = time;
+            this.seconds = time.getEpochSecond();
+            this.nanos = time.getNano();
             this.line = line;
         }
 
@@ -468,7 +982,7 @@ public class DefaultHistory implements History {
         }
 
         public Instant time() {
-            return time;
+            return Instant.ofEpochSecond(seconds, nanos);
         }
 
         public String line() {
@@ -481,6 +995,105 @@ public class DefaultHistory implements History {
         }
     }
 
+    /**
+     * Entry loaded from a history file, decoded on first access.
+     */
+    private static class LazyEntry implements Entry {
+
+        private final int index;
+        private final long millis;
+        private Instant time;
+        private volatile byte[] data;
+        private final int start;
+        private final int end;
+        private final boolean escaped;
+        private volatile String line;
+
+        private LazyEntry(int index, long millis, Instant time, byte[] data, int start, int end, boolean escaped) {
+            this.index = index;
+            this.millis = millis;
+            this.time = time;
+            this.data = data;
+            this.start = start;
+            this.end = end;
+            this.escaped = escaped;
+        }
+
+        /**
+         * Creates an entry for the current record of a binary history file.
+         */
+        static LazyEntry create(int index, byte[] data, BinaryHistoryFile.Records records) {
+            return new LazyEntry(index, records.millis(), null, data, records.start(), records.end(), false);
+        }
+
+        /**
+         * Creates an entry for the line between <code>start</code> and <code>end</code>,
+         * only checking the timestamp syntax.
+         */
+        static LazyEntry create(Path path, int index, byte[] data, int start, int end,
+                                boolean timestamped, Instant now) {
+            if (!timestamped) {
+                return new LazyEntry(index, 0, now, data, start, end, true);
+            }
+            int idx = start;
+            while (idx < end && data[idx] != ':') {
+                idx++;
+            }
+            int i = start;
+            boolean negative = idx > i && data[i] == '-';
+            if (idx > i && (data[i] == '-' || data[i] == '+')) {
+                i++;
+            }
+            if (idx == end || i == idx) {
+                throw new IllegalArgumentException(badHistoryFileSyntax(path));
+            }
+            long millis = 0;
+            for (; i < idx; i++) {
+                int digit = data[i] - '0';
+                if (digit < 0 || digit > 9 || millis > (Long.MAX_VALUE - digit) / 10) {
+                    throw new IllegalArgumentException(badHistoryFileSyntax(path));
+                }
+                millis = millis * 10 + digit;
+            }
+            return new LazyEntry(index, negative ? -millis : millis, null, data, idx + 1, end, true);
+        }
+
+        public int index() {
+            return index;
+        }
+
+        public Instant time() {
+            if (time == null) {
+                time = Instant.ofEpochMilli(millis);
+            }
+            return time;
+        }
+
+        public String line() {
+            String l = line;
+            if (l == null) {
+                byte[] d = data;
+                if (d == null) {
+                    // decoded by another thread, which set the line first
+                    return line;
+                }
+                l = new String(d, start, end - start, StandardCharsets.UTF_8);
+                if (escaped) {
+                    l = unescape(l);
+                }
+                line = l;
+                // the file contents are shared with the entries not yet decoded
+                data = null;
+            }
+            return l;
+        }
+
+        @Override
+        public String toString() {
+            return String.format("%d: %s", index, line());
+        }
+    }
+
     //
     // Navigation
     //
@@ -629,9 +1242,125 @@ public class DefaultHistory implements History {
         return sb.toString();
     }
 
+    /**
+     * A shared history file, locked against both the other processes
+     * and the other sessions of this process, as file locks are held
+     * on behalf of the whole JVM.  The file is read and written through
+     * the channel holding the lock, as locks are mandatory on some systems.
+     */
+    private static class SharedFile implements Closeable {
+
+        private static final Map<String, ReentrantLock> LOCKS = new ConcurrentHashMap<>();
+
+        private final ReentrantLock lock;
+        final FileChannel channel;
+        private final FileLock fileLock;
+        // nobody else writes to the file while it is locked
+        private long end;
+
+        SharedFile(Path path) throws IOException {
+            lock = LOCKS.computeIfAbsent(path.toAbsolutePath().normalize().toString(), k -> new ReentrantLock());
+            lock.lock();
+            FileChannel ch = null;
+            try {
+                ch = FileChannel.open(path, StandardOpenOption.READ,
+                        StandardOpenOption.WRITE, StandardOpenOption.CREATE);
+                fileLock = ch.lock();
+                end = ch.size();
+            } catch (IOException | RuntimeException e) {
+                try {
+                    if (ch != null) {
+                        ch.close();
+                    }
+                } finally {
+                    lock.unlock();
+                }
+                throw e;
+            }
+            channel = ch;
+        }
+
+        long size() {
+            return end;
+        }
+
+        byte[] read(long from, long to) throws IOException {
+            if (to - from > Integer.MAX_VALUE - 8) {
+                throw new IOException("History file too large");
+            }
+            byte[] bytes = new byte[(int) (to - from)];
+            readFully(channel, ByteBuffer.wrap(bytes), from);
+            return bytes;
+        }
+
+        void append(byte[] bytes) throws IOException {
+            write(bytes, end);
+            end += bytes.length;
+        }
+
+        /**
+         * Replaces the contents of the file, writing over them before truncating
+         * the file, so that it is never left empty if the write fails.
+         */
+        void overwrite(byte[] bytes) throws IOException {
+            write(bytes, 0);
+            channel.truncate(bytes.length);
+            end = bytes.length;
+        }
+
+        private void write(byte[] bytes, long position) throws IOException {
+            ByteBuffer buffer = ByteBuffer.wrap(bytes);
+            while (buffer.hasRemaining()) {
+                channel.write(buffer, position + buffer.position());
+            }
+        }
+
+        boolean isBinary() throws IOException {
+            return BinaryHistoryFile.isBinary(channel);
+        }
+
+        /**
+         * Number of entries of a binary file.
+         */
+        int count() throws IOException {
+            return BinaryHistoryFile.count(channel, size());
+        }
+
+        /**
+         * Remembers the end of the file, along with its last bytes
+         * which are used to detect that the file has been rewritten.
+         */
+        void mark(HistoryFileData data, long position) throws IOException {
+            data.position = position;
+            data.mark = read(Math.max(0, position - MARK_SIZE), position);
+        }
+
+        boolean isMarked(HistoryFileData data) throws IOException {
+            long size = size();
+            return data.position <= size
+                    && Arrays.equals(data.mark, read(data.position - data.mark.length, data.position));
+        }
+
+        @Override
+        public void close() throws IOException {
+            try {
+                fileLock.release();
+            } finally {
+                try {
+                    channel.close();
+                } finally {
+                    lock.unlock();
+                }
+            }
+        }
+    }
+
     private static class HistoryFileData {
         private int lastLoaded = 0;
         private int entriesInFile = 0;
+        // end of the file and its last bytes, for shared history files
+        private long position = 0;
+        private byte[] mark = new byte[0];
         
         public HistoryFileData() {
         }
@@ -650,10 +1379,11 @@ public class DefaultHistory implements History {
         }
         
         public void decLastLoaded() {
-            lastLoaded = lastLoaded - 1;
-            if (lastLoaded < 0) {
-                lastLoaded = 0;
-            }
+            decLastLoaded(1);
+        }
+
+        public void decLastLoaded(int amount) {
+            lastLoaded = Math.max(lastLoaded - amount, 0);
         }
         
         public int getEntriesInFile() {
@@ -0,0 +1,310 @@
+/*
+ * Copyright (c) 2002-2021, the original author or authors.
+ *
+ * This software is distributable under the BSD license. See the terms of the
+ * BSD license in the documentation provided with this software.
+ *
+ * https://opensource.org/licenses/BSD-3-Clause
+ */
+package org.jline.reader.impl.history;
+
+import java.util.HashMap;
+import java.util.ListIterator;
+import java.util.Map;
+
+import org.jline.reader.LineReader;
+
+/**
+ * {@link DefaultHistory} maintaining an index of the trigrams of
+ * the (lower cased) entries, so that substring and prefix searches
+ * only look at the entries which may match instead of scanning
+ * the whole history.
+ * <p>
+ * The index is updated incrementally when entries are added or
+ * evicted.  It is only built on the first search after the history
+ * has been cleared or loaded, so that loading doesn't decode all the
+ * entries.  Searches for terms shorter than three characters
+ * fall back to a linear scan.
+ * </p>
+ */
+public class IndexedHistory extends DefaultHistory {
+
+    private static final int GRAM = 3;
+
+    private final Map<Long, Postings> index = new HashMap<>();
+    private String[] lines = new String[16];
+    private int head;
+    private int count;
+    private int base;
+    private boolean valid = true;
+
+    public IndexedHistory() {
+    }
+
+    public IndexedHistory(LineReader reader) {
+        // attach once the index is initialized, as it loads the history
+        attach(reader);
+    }
+
+    @Override
+    public int searchBackwards(String searchTerm, int startIndex, boolean startsWith, boolean caseInsensitive) {
+        Postings postings = candidates(searchTerm);
+        if (postings == null) {
+            return super.searchBackwards(searchTerm, startIndex, startsWith, caseInsensitive);
+        }
+        String term = caseInsensitive ? searchTerm.toLowerCase() : searchTerm;
+        for (int i = postings.lowerBound(startIndex) - 1; i >= 0; i--) {
+            int idx = postings.get(i);
+            if (matches(line(idx), term, startsWith, caseInsensitive)) {
+                return idx;
+            }
+        }
+        return -1;
+    }
+
+    @Override
+    public int searchForwards(String searchTerm, int startIndex, boolean startsWith, boolean caseInsensitive) {
+        Postings postings = candidates(searchTerm);
+        if (postings == null) {
+            return super.searchForwards(searchTerm, startIndex, startsWith, caseInsensitive);
+        }
+        String term = caseInsensitive ? searchTerm.toLowerCase() : searchTerm;
+        for (int i = postings.lowerBound(startIndex); i < postings.size; i++) {
+            int idx = postings.get(i);
+            if (matches(line(idx), term, startsWith, caseInsensitive)) {
+                return idx;
+            }
+        }
+        return -1;
+    }
+
+    @Override
+    public ListIterator<Entry> iterator(int index) {
+        ListIterator<Entry> it = super.iterator(index);
+        // entries removed through the iterator invalidate the whole index
+        return new ListIterator<Entry>() {
+            @Override
+            public boolean hasNext() {
+                return it.hasNext();
+            }
+
+            @Override
+            public Entry next() {
+                return it.next();
+            }
+
+            @Override
+            public boolean hasPrevious() {
+                return it.hasPrevious();
+            }
+
+            @Override
+            public Entry previous() {
+                return it.previous();
+            }
+
+            @Override
+            public int nextIndex() {
+                return it.nextIndex();
+            }
+
+            @Override
+            public int previousIndex() {
+                return it.previousIndex();
+            }
+
+            @Override
+            public void remove() {
+                it.remove();
+                valid = false;
+            }
+
+            @Override
+            public void set(Entry entry) {
+                it.set(entry);
+                valid = false;
+            }
+
+            @Override
+            public void add(Entry entry) {
+                it.add(entry);
+                valid = false;
+            }
+        };
+    }
+
+    @Override
+    protected void entryAdded(Entry entry) {
+        if (!valid) {
+            return;
+        }
+        if (count == 0) {
+            base = entry.index();
+        } else if (entry.index() != base + count) {
+            valid = false;
+            return;
+        }
+        if (count == lines.length) {
+            String[] nl = new String[lines.length * 2];
+            for (int i = 0; i < count; i++) {
+                nl[i] = lines[(head + i) % lines.length];
+            }
+            lines = nl;
+            head = 0;
+        }
+        lines[(head + count++) % lines.length] = entry.line();
+        String folded = entry.line().toLowerCase();
+        for (int i = 0; i + GRAM <= folded.length(); i++) {
+            index.computeIfAbsent(key(folded, i), k -> new Postings()).add(entry.index());
+        }
+    }
+
+    @Override
+    protected void entryRemoved(Entry entry) {
+        if (!valid) {
+            return;
+        }
+        if (count == 0 || entry.index() != base) {
+            valid = false;
+            return;
+        }
+        String folded = lines[head].toLowerCase();
+        lines[head] = null;
+        head = (head + 1) % lines.length;
+        count--;
+        base++;
+        for (int i = 0; i + GRAM <= folded.length(); i++) {
+            Long key = key(folded, i);
+            Postings postings = index.get(key);
+            if (postings != null) {
+                postings.removeFirst(entry.index());
+                if (postings.size == 0) {
+                    index.remove(key);
+                }
+            }
+        }
+    }
+
+    @Override
+    protected void entriesCleared() {
+        reset();
+        valid = false;
+    }
+
+    private void reset() {
+        index.clear();
+        lines = new String[16];
+        head = 0;
+        count = 0;
+        base = 0;
+    }
+
+    /**
+     * Returns the entries which may contain the given term,
+     * or <code>null</code> if the index can't be used.
+     */
+    private Postings candidates(String searchTerm) {
+        String folded = searchTerm.toLowerCase();
+        if (folded.length() < GRAM || folded.length() != searchTerm.length()) {
+            return null;
+        }
+        if (!valid) {
+            rebuild();
+        }
+        // Pick the rarest trigram of the term
+        Postings best = null;
+        for (int i = 0; i + GRAM <= folded.length(); i++) {
+            Postings postings = index.get(key(folded, i));
+            if (postings == null) {
+                return Postings.EMPTY;
+            }
+            if (best == null || postings.size < best.size) {
+                best = postings;
+            }
+        }
+        return best;
+    }
+
+    private void rebuild() {
+        reset();
+        valid = true;
+        int idx = first();
+        for (Entry entry : this) {
+            entryAdded(new EntryImpl(idx++, entry.time(), entry.line()));
+        }
+    }
+
+    private String line(int idx) {
+        return lines[(head + idx - base) % lines.length];
+    }
+
+    private static boolean matches(String line, String term, boolean startsWith, boolean caseInsensitive) {
+        if (caseInsensitive) {
+            line = line.toLowerCase();
+        }
+        return startsWith ? line.startsWith(term) : line.contains(term);
+    }
+
+    private static Long key(String str, int i) {
+        return ((long) str.charAt(i) << 32) | ((long) str.charAt(i + 1) << 16) | str.charAt(i + 2);
+    }
+
+    /**
+     * Sorted list of entry indexes, with cheap removal at the head.
+     */
+    private static class Postings {
+
+        static final Postings EMPTY = new Postings();
+
+        int[] data = new int[4];
+        int start;
+        int size;
+
+        int get(int i) {
+            return data[start + i];
+        }
+
+        void add(int idx) {
+            // a trigram may appear several times in the same line
+            if (size > 0 && data[start + size - 1] == idx) {
+                return;
+            }
+            if (start + size == data.length) {
+                if (start > data.length / 2) {
+                    System.arraycopy(data, start, data, 0, size);
+                } else {
+                    int[] nd = new int[data.length * 2];
+                    System.arraycopy(data, start, nd, 0, size);
+                    data = nd;
+                }
+                start = 0;
+            }
+            data[start + size++] = idx;
+        }
+
+        void removeFirst(int idx) {
+            if (size > 0 && data[start] == idx) {
+                start++;
+                size--;
+            }
+        }
+
+        /**
+         * Position of the first index greater or equal to the given one.
+         */
+        int lowerBound(int idx) {
+            int lo = 0;
+            int hi = size;
+            while (lo < hi) {
+                int mid = (lo + hi) >>> 1;
+                if (data[start + mid] < idx) {
+                    lo = mid + 1;
+                } else {
+                    hi = mid;
+                }
+            }
+            return lo;
+        }
+    }
+
+}
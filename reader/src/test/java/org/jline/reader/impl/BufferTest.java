@@ -12,6 +12,7 @@ import org.junit.Test;
 
 import static org.junit.Assert.assertEquals;
 import static org.junit.Assert.assertFalse;
+import static org.junit.Assert.assertSame;
 import static org.junit.Assert.assertTrue;
 
 public class BufferTest {
@@ -45,4 +46,62 @@ public class BufferTest {
         assertEquals(22, buffer.cursor());
         assertFalse(buffer.down());
     }
+
+    @Test
+    public void testChanges() {
+        BufferImpl buffer = new BufferImpl();
+        buffer.write("abc\ndef\nghi");
+        buffer.clearChanges();
+        assertEquals(0, buffer.changeEnd() - buffer.changeStart() + buffer.changeRemoved());
+
+        buffer.cursor(5);
+        buffer.write("xy");                // abc\ndxyef\nghi
+        buffer.cursor(1);
+        buffer.delete(1);                  // ac\ndxyef\nghi
+        assertEquals(1, buffer.changeStart());
+        assertEquals(6, buffer.changeEnd());
+        assertEquals(4, buffer.changeRemoved());
+
+        buffer.clearChanges();
+        buffer.cursor(buffer.length());
+        buffer.backspace(2);               // ac\ndxyef\ng
+        assertEquals(10, buffer.changeStart());
+        assertEquals(10, buffer.changeEnd());
+        assertEquals(2, buffer.changeRemoved());
+    }
+
+    @Test
+    public void testStringViews() {
+        BufferImpl buffer = new BufferImpl(4);
+        buffer.write("hello world");
+        buffer.cursor(5);
+        buffer.write(",");                 // the gap follows the comma
+        assertEquals("hello, world", buffer.toString());
+        assertEquals("o, w", buffer.substring(4, 8));
+        assertEquals("hello,", buffer.upToCursor());
+        assertSame(buffer.toString(), buffer.toString());
+        assertSame(buffer.upToCursor(), buffer.upToCursor());
+
+        buffer.move(-1);
+        assertEquals("hello", buffer.upToCursor());
+        buffer.delete();
+        assertEquals("hello world", buffer.toString());
+        buffer.cursor(buffer.length());
+        assertSame(buffer.toString(), buffer.upToCursor());
+    }
+
+    @Test
+    public void testApplyEdit() {
+        BufferImpl buffer = new BufferImpl();
+        buffer.write("hello world");
+        BufferImpl.Edit edit = new BufferImpl.Edit(6, "world", "there");
+        assertTrue(buffer.apply(edit, false));
+        assertEquals("hello there", buffer.toString());
+        // the buffer no longer contains the replaced text
+        assertFalse(buffer.apply(edit, false));
+        assertEquals("hello there", buffer.toString());
+        assertTrue(buffer.apply(edit, true));
+        assertEquals("hello world", buffer.toString());
+        assertFalse(buffer.apply(new BufferImpl.Edit(20, "", "x"), false));
+    }
 }
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2002-2021, the original author or authors.
+ *
+ * This software is distributable under the BSD license. See the terms of the
+ * BSD license in the documentation provided with this software.
+ *
+ * https://opensource.org/licenses/BSD-3-Clause
+ */
+package org.jline.reader.impl;
+
+import java.io.IOException;
+import java.util.ArrayList;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Map;
+import java.util.Random;
+import java.util.TreeSet;
+
+import org.jline.reader.Candidate;
+import org.jline.reader.CompletingParsedLine;
+import org.jline.reader.LineReader;
+import org.jline.reader.Parser.ParseContext;
+import org.junit.Test;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertTrue;
+
+public class CandidateIndexTest extends ReaderTestSupport {
+
+    private static final String[] PARTS = { "customer", "Order", "invoice", "_", "id", "ID", "line", "a", "b" };
+
+    private static List<Candidate> candidates() {
+        Random random = new Random(1);
+        List<Candidate> candidates = new ArrayList<>();
+        for (int i = 0; i < 2000; i++) {
+            StringBuilder sb = new StringBuilder();
+            for (int j = random.nextInt(4); j >= 0; j--) {
+                sb.append(PARTS[random.nextInt(PARTS.length)]);
+            }
+            candidates.add(new Candidate(sb.toString()));
+        }
+        return candidates;
+    }
+
+    private static TreeSet<String> values(List<Candidate> candidates) {
+        TreeSet<String> values = new TreeSet<>();
+        for (Candidate candidate : candidates) {
+            values.add(candidate.value() + "/" + System.identityHashCode(candidate));
+        }
+        return values;
+    }
+
+    private static List<Candidate> match(String word, boolean prefix, boolean caseInsensitive, List<Candidate> candidates) {
+        CompletingParsedLine line = (CompletingParsedLine) new DefaultParser()
+                .parse(word, word.length(), ParseContext.COMPLETE);
+        Map<LineReader.Option, Boolean> options = new HashMap<>();
+        options.put(LineReader.Option.COMPLETE_MATCHER_TYPO, false);
+        CompletionMatcherImpl matcher = new CompletionMatcherImpl();
+        matcher.compile(options, prefix, line, caseInsensitive, 2, "original");
+        return matcher.matches(candidates);
+    }
+
+    @Test
+    public void testSameMatches() {
+        List<Candidate> all = candidates();
+        Candidate extra = new Candidate("customerExtra");
+        List<Candidate> plain = new ArrayList<>(all);
+        plain.add(extra);
+        CandidateIndex index = new CandidateIndex(all);
+        for (String word : new String[] { "cust", "custOmer", "order", "Order", "der_", "dI", "a", "zz", "line" }) {
+            for (boolean prefix : new boolean[] { false, true }) {
+                for (boolean caseInsensitive : new boolean[] { false, true }) {
+                    CandidateList list = new CandidateList();
+                    list.addAll(index);
+                    list.add(extra);
+                    assertTrue(list.indexes() != null);
+                    assertEquals(word + "/" + prefix + "/" + caseInsensitive,
+                            values(match(word, prefix, caseInsensitive, plain)),
+                            values(match(word, prefix, caseInsensitive, list)));
+                }
+            }
+        }
+    }
+
+    @Test
+    public void testTypos() {
+        List<Candidate> all = candidates();
+        CandidateIndex index = new CandidateIndex(all);
+        Random random = new Random(2);
+        for (int t = 0; t < 200; t++) {
+            String word = all.get(random.nextInt(all.size())).value();
+            StringBuilder sb = new StringBuilder(word);
+            for (int e = random.nextInt(3); e >= 0 && sb.length() > 1; e--) {
+                int pos = random.nextInt(sb.length() - 1);
+                switch (random.nextInt(4)) {
+                    case 0:
+                        sb.deleteCharAt(pos);
+                        break;
+                    case 1:
+                        sb.insert(pos, 'x');
+                        break;
+                    case 2:
+                        sb.setCharAt(pos, 'y');
+                        break;
+                    default:
+                        char c = sb.charAt(pos);
+                        sb.setCharAt(pos, sb.charAt(pos + 1));
+                        sb.setCharAt(pos + 1, c);
+                        break;
+                }
+            }
+            for (boolean caseInsensitive : new boolean[] { false, true }) {
+                String typo = caseInsensitive ? sb.toString().toLowerCase() : sb.toString();
+                for (int errors = 1; errors <= 3; errors++) {
+                    TreeSet<String> expected = new TreeSet<>();
+                    for (Candidate candidate : all) {
+                        String value = caseInsensitive ? candidate.value().toLowerCase() : candidate.value();
+                        if (ReaderUtils.distance(typo, value) < errors) {
+                            expected.add(candidate.value());
+                        }
+                    }
+                    Map<String, List<Candidate>> out = new HashMap<>();
+                    index.typos(typo, errors, caseInsensitive, out);
+                    assertEquals(typo + "/" + errors, expected, new TreeSet<>(out.keySet()));
+                }
+            }
+        }
+    }
+
+    @Test
+    public void testModifiedList() {
+        CandidateList list = new CandidateList();
+        list.addAll(new CandidateIndex(candidates()));
+        list.remove(0);
+        assertEquals(null, list.indexes());
+        assertEquals(values(match("cust", false, false, new ArrayList<>(list))),
+                values(match("cust", false, false, list)));
+    }
+
+    @Test
+    public void testComplete() throws IOException {
+        List<Candidate> candidates = new ArrayList<>();
+        candidates.add(new Candidate("customer_orders"));
+        candidates.add(new Candidate("customer_order_lines"));
+        candidates.add(new Candidate("invoices"));
+        CandidateIndex index = new CandidateIndex(candidates);
+        reader.setCompleter((reader, line, cands) -> cands.addAll(index));
+
+        assertBuffer("invoices ", new TestBuffer("inv").tab());
+        assertBuffer("customer_order", new TestBuffer("cust").tab());
+        assertBuffer("invoices ", new TestBuffer("voic").tab());
+    }
+
+}
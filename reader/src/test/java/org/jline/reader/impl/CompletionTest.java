@@ -9,7 +9,14 @@
 package org.jline.reader.impl;
 
 import java.io.IOException;
+import java.util.ArrayList;
 import java.util.Arrays;
+import java.util.List;
+import java.util.concurrent.CountDownLatch;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.TimeUnit;
+import java.util.stream.Collectors;
 
 import org.jline.reader.*;
 import org.jline.reader.LineReader.Option;
@@ -20,6 +27,7 @@ import org.jline.reader.impl.completer.StringsCompleter;
 import org.jline.terminal.Size;
 import org.junit.Test;
 
+import static org.junit.Assert.assertEquals;
 import static org.junit.Assert.assertFalse;
 import static org.junit.Assert.assertTrue;
 
@@ -32,6 +40,91 @@ public class CompletionTest extends ReaderTestSupport {
         assertBuffer("\"foo bar\" ", new TestBuffer("\"fo\t"));
     }
 
+    @Test
+    public void testCompleteAsync() throws IOException {
+        reader.setOpt(Option.COMPLETE_ASYNC);
+        reader.setCompleter(new AggregateCompleter(
+                new StringsCompleter("foo", "bar"),
+                new StringsCompleter("foobar", "baz")));
+        assertBuffer("foo", new TestBuffer("fo\t"));
+        assertBuffer("baz ", new TestBuffer("baz\t"));
+    }
+
+    @Test
+    public void testCompleteAsyncCancelled() throws IOException {
+        reader.setOpt(Option.COMPLETE_ASYNC);
+        reader.setCompleter((reader, line, candidates) -> {
+            try {
+                Thread.sleep(10000);
+            } catch (InterruptedException e) {
+                return;
+            }
+            candidates.add(new Candidate("foo"));
+        });
+        assertBuffer("fox", new TestBuffer("fo\tx"));
+    }
+
+    @Test
+    public void testCompleteIncrementallyKeepsIndexes() {
+        CandidateIndex index = new CandidateIndex(Arrays.asList(new Candidate("foo"), new Candidate("bar")));
+        Completer completer = (reader, line, candidates) -> {
+            candidates.add(new Candidate("baz"));
+            candidates.addAll(index);
+        };
+        List<List<Candidate>> batches = new ArrayList<>();
+        LineReaderImpl.completeIncrementally(reader, completer, reader.getParser().parse("", 0), batches::add);
+        assertEquals(2, batches.size());
+        assertTrue(batches.get(0) == index);
+        assertEquals("baz", batches.get(1).get(0).value());
+    }
+
+    @Test
+    public void testCompleteParallel() throws InterruptedException {
+        reader.setOpt(Option.COMPLETE_PARALLEL);
+        reader.setVariable(LineReader.COMPLETER_TIMEOUT, 200);
+        CountDownLatch fast = new CountDownLatch(1);
+        CountDownLatch cancelled = new CountDownLatch(1);
+        AggregateCompleter completer = new AggregateCompleter(
+                (reader, line, candidates) -> {
+                    // only completes if the next completer runs concurrently
+                    if (await(fast)) {
+                        candidates.add(new Candidate("slow"));
+                    }
+                },
+                (reader, line, candidates) -> {
+                    candidates.add(new Candidate("fast"));
+                    fast.countDown();
+                },
+                (reader, line, candidates) -> {
+                    throw new IllegalStateException("failing completer");
+                },
+                (reader, line, candidates) -> {
+                    if (!await(new CountDownLatch(1))) {
+                        cancelled.countDown();
+                    }
+                    candidates.add(new Candidate("late"));
+                });
+        ExecutorService executor = Executors.newCachedThreadPool();
+        try {
+            completer.setExecutor(executor);
+            List<Candidate> candidates = new ArrayList<>();
+            completer.complete(reader, reader.getParser().parse("", 0), candidates);
+            assertEquals(Arrays.asList("slow", "fast"),
+                    candidates.stream().map(Candidate::value).collect(Collectors.toList()));
+            assertTrue(cancelled.await(10, TimeUnit.SECONDS));
+        } finally {
+            executor.shutdownNow();
+        }
+    }
+
+    private static boolean await(CountDownLatch latch) {
+        try {
+            return latch.await(10, TimeUnit.SECONDS);
+        } catch (InterruptedException e) {
+            return false;
+        }
+    }
+
     @Test
     public void testListAndMenu() throws IOException {
         reader.setCompleter(new StringsCompleter("foo", "foobar"));
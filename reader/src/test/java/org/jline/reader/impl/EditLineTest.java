@@ -14,6 +14,7 @@ import org.jline.reader.Reference;
 import org.junit.Test;
 
 import static org.jline.keymap.KeyMap.ctrl;
+import static org.jline.reader.LineReader.BACKWARD_CHAR;
 import static org.jline.reader.LineReader.BACKWARD_KILL_LINE;
 import static org.jline.reader.LineReader.BACKWARD_KILL_WORD;
 import static org.jline.reader.LineReader.BACKWARD_WORD;
@@ -337,4 +338,30 @@ public class EditLineTest
             ((DefaultParser) reader.getParser()).setEofOnEscapedNewLine(prev);
         }
     }
+
+    @Test
+    public void testPasteBurst() throws Exception {
+        reader.setVariable(LineReader.PASTE_BURST_TIMEOUT, 1000L);
+        // the pasted text is a single edit
+        assertBuffer("", new TestBuffer("pasted text").ctrl('_'));
+
+        // characters bound to another widget are not part of the burst
+        reader.getWidgets().put("insert-x", () -> {
+            reader.getBuffer().write("X");
+            return true;
+        });
+        reader.getKeyMaps().get(reader.getKeyMap()).bind(new Reference("insert-x"), "x");
+        assertBuffer("abXcd", new TestBuffer("abxcd"));
+        assertBuffer("abX", new TestBuffer("abxcd").ctrl('_'));
+    }
+
+    @Test
+    public void testUndo() throws Exception {
+        reader.setVariable(LineReader.PASTE_BURST_TIMEOUT, 0L);
+        assertBuffer("foo ", new TestBuffer("foo bar").op(BACKWARD_KILL_WORD));
+        assertBuffer("foo bar", new TestBuffer("foo bar").op(BACKWARD_KILL_WORD).ctrl('_'));
+        // consecutive self inserts are undone at once
+        assertBuffer("", new TestBuffer("foo bar").op(BACKWARD_KILL_WORD).ctrl('_').ctrl('_'));
+        assertBuffer("foo", new TestBuffer("foo").op(BACKWARD_CHAR).op(BACKWARD_CHAR).append("bar").ctrl('_'));
+    }
 }
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2002-2021, the original author or authors.
+ *
+ * This software is distributable under the BSD license. See the terms of the
+ * BSD license in the documentation provided with this software.
+ *
+ * https://opensource.org/licenses/BSD-3-Clause
+ */
+package org.jline.reader.impl;
+
+import java.util.Random;
+import java.util.regex.Pattern;
+
+import org.jline.reader.LineReader;
+import org.jline.reader.LineReader.RegionType;
+import org.jline.utils.AttributedString;
+import org.jline.utils.AttributedStringBuilder;
+import org.jline.utils.AttributedStyle;
+import org.junit.Test;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
+import static org.junit.Assert.assertTrue;
+
+public class HighlighterTest extends ReaderTestSupport {
+
+    /**
+     * Highlights in bold the text between parentheses, which may span several lines.
+     */
+    private static class ParenHighlighter extends DefaultHighlighter {
+        int highlighted;
+
+        @Override
+        protected Object initialState(LineReader reader, String buffer) {
+            return 0;
+        }
+
+        @Override
+        protected Object highlightLine(LineReader reader, String buffer, int start, int end, Object state,
+                                       AttributedStringBuilder sb) {
+            highlighted++;
+            int depth = (Integer) state;
+            for (int i = start; i < end; i++) {
+                char c = buffer.charAt(i);
+                if (c == '(') {
+                    depth++;
+                }
+                sb.style(depth > 0 ? AttributedStyle.BOLD : AttributedStyle.DEFAULT).append(c);
+                if (c == ')' && depth > 0) {
+                    depth--;
+                }
+            }
+            return depth;
+        }
+    }
+
+    private AttributedString highlight(ParenHighlighter highlighter, BufferImpl buffer, int length) {
+        int start = buffer.changeStart();
+        int removed = buffer.changeRemoved();
+        int inserted = buffer.changeEnd() - start;
+        buffer.clearChanges();
+        assertEquals(length, buffer.length() - inserted + removed);
+        return highlighter.highlight(reader, buffer.toString(), start, removed, inserted);
+    }
+
+    @Test
+    public void testIncremental() {
+        reader.regionActive = RegionType.NONE;
+        ParenHighlighter highlighter = new ParenHighlighter();
+        BufferImpl buffer = new BufferImpl();
+        StringBuilder sb = new StringBuilder();
+        for (int i = 0; i < 100; i++) {
+            sb.append("line ").append(i).append('\n');
+        }
+        buffer.write(sb);
+        AttributedString str = highlight(highlighter, buffer, 0);
+        assertEquals(101, highlighter.highlighted);
+
+        // a single line is highlighted again
+        highlighter.highlighted = 0;
+        buffer.cursor(50);
+        buffer.write("x");
+        AttributedString incremental = highlight(highlighter, buffer, str.length());
+        assertEquals(1, highlighter.highlighted);
+        assertEquals(new ParenHighlighter().highlight(reader, buffer.toString()), incremental);
+
+        // an unterminated parenthesis changes the state of the following lines
+        highlighter.highlighted = 0;
+        buffer.write("(");
+        incremental = highlight(highlighter, buffer, incremental.length());
+        assertTrue(highlighter.highlighted > 90);
+        assertEquals(AttributedStyle.BOLD, incremental.styleAt(incremental.length() - 2));
+
+        Random random = new Random(1);
+        for (int i = 0; i < 200; i++) {
+            int length = buffer.length();
+            buffer.cursor(random.nextInt(length + 1));
+            switch (random.nextInt(3)) {
+                case 0:
+                    buffer.write("(\n)x".substring(random.nextInt(4)));
+                    break;
+                case 1:
+                    buffer.delete(random.nextInt(5));
+                    break;
+                default:
+                    buffer.backspace(random.nextInt(5));
+                    break;
+            }
+            if (random.nextBoolean()) {
+                incremental = highlight(highlighter, buffer, incremental.length());
+                assertEquals(new ParenHighlighter().highlight(reader, buffer.toString()), incremental);
+            }
+        }
+    }
+
+    @Test
+    public void testSearchTerm() {
+        reader.regionActive = RegionType.NONE;
+        DefaultHighlighter highlighter = new DefaultHighlighter();
+        highlighter.highlight(reader, "abc\ndef", 0, 0, 7);
+        reader.searchTerm = new StringBuffer("de");
+        AttributedString str = highlighter.highlight(reader, "abc\ndef", 0, 0, 0);
+        assertEquals(AttributedStyle.DEFAULT, str.styleAt(0));
+        assertEquals(AttributedStyle.DEFAULT.underline(), str.styleAt(4));
+        assertEquals(AttributedStyle.DEFAULT, str.styleAt(6));
+        reader.searchTerm = null;
+        str = highlighter.highlight(reader, "abc\ndef", 0, 0, 0);
+        assertEquals(AttributedStyle.DEFAULT, str.styleAt(4));
+    }
+
+    @Test
+    public void testErrorPattern() {
+        reader.regionActive = RegionType.NONE;
+        DefaultHighlighter highlighter = new DefaultHighlighter();
+        highlighter.setErrorPattern(Pattern.compile("bad"));
+        highlighter.highlight(reader, "bad\nok", 0, 0, 6);
+        // the unchanged line keeps its match
+        AttributedString str = highlighter.highlight(reader, "bad\nok bad", 6, 0, 4);
+        assertEquals(AttributedStyle.INVERSE, str.styleAt(0));
+        assertEquals(AttributedStyle.DEFAULT, str.styleAt(4));
+        assertEquals(AttributedStyle.INVERSE, str.styleAt(7));
+        // a new pattern applies to all the lines
+        highlighter.setErrorPattern(Pattern.compile("ok"));
+        str = highlighter.highlight(reader, "bad\nok bad", 0, 0, 0);
+        assertEquals(AttributedStyle.DEFAULT, str.styleAt(0));
+        assertEquals(AttributedStyle.INVERSE, str.styleAt(4));
+        // matches spanning several lines
+        highlighter.setErrorPattern(Pattern.compile("d\nok"));
+        str = highlighter.highlight(reader, "bad\nok bad", 0, 0, 0);
+        assertEquals(AttributedStyle.DEFAULT, str.styleAt(1));
+        assertEquals(AttributedStyle.INVERSE, str.styleAt(2));
+        assertEquals(AttributedStyle.INVERSE, str.styleAt(5));
+        assertEquals(AttributedStyle.DEFAULT, str.styleAt(6));
+    }
+
+    @Test
+    public void testOverriddenHighlight() {
+        reader.regionActive = RegionType.NONE;
+        assertTrue(new DefaultHighlighter().isIncremental());
+        DefaultHighlighter highlighter = new DefaultHighlighter() {
+            @Override
+            public AttributedString highlight(LineReader reader, String buffer) {
+                return new AttributedString(buffer, AttributedStyle.BOLD);
+            }
+        };
+        assertFalse(highlighter.isIncremental());
+        AttributedString str = highlighter.highlight(reader, "foo", 0, 0, 3);
+        assertEquals(AttributedStyle.BOLD, str.styleAt(0));
+    }
+
+}
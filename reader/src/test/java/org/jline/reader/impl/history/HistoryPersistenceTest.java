@@ -9,13 +9,17 @@
 package org.jline.reader.impl.history;
 
 import java.io.IOException;
+import java.nio.charset.StandardCharsets;
 import java.nio.file.Files;
+import java.nio.file.Path;
 import java.nio.file.Paths;
+import java.time.Instant;
 import java.util.List;
 import java.util.concurrent.BrokenBarrierException;
 import java.util.concurrent.CyclicBarrier;
 import java.util.stream.IntStream;
 
+import org.jline.reader.History;
 import org.jline.reader.LineReader;
 import org.jline.reader.impl.ReaderTestSupport;
 import org.junit.After;
@@ -24,6 +28,8 @@ import org.junit.Test;
 
 import static java.util.stream.Collectors.toList;
 import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertTrue;
+import static org.junit.Assert.fail;
 
 /**
  * Tests file history.
@@ -72,6 +78,235 @@ public class HistoryPersistenceTest extends ReaderTestSupport {
         }
     }
 
+    @Test
+    public void testLoadTail() throws Exception {
+        reader.setVariable(LineReader.HISTORY_FILE, Paths.get("test"));
+        reader.setVariable(LineReader.HISTORY_SIZE, 10);
+        StringBuilder sb = new StringBuilder();
+        for (int i = 0; i < 25; i++) {
+            sb.append(1000 + i).append(":cmd").append(i).append(i % 2 == 0 ? "\\nx" : "").append("\r\n");
+        }
+        Files.write(Paths.get("test"), sb.toString().getBytes(StandardCharsets.UTF_8));
+
+        // the entries are numbered from the start of the file
+        DefaultHistory history = new DefaultHistory(reader);
+        assertEquals(10, history.size());
+        assertEquals(15, history.first());
+        assertEquals(24, history.last());
+        assertEquals("cmd15", history.get(15));
+        assertEquals("cmd24\nx", history.get(24));
+        History.Entry entry = history.iterator(16).next();
+        assertEquals(16, entry.index());
+        assertEquals(1016, entry.time().toEpochMilli());
+
+        // only new entries are appended
+        history.add("new");
+        history.save();
+        List<String> lines = Files.readAllLines(Paths.get("test"));
+        assertEquals(26, lines.size());
+        assertTrue(lines.get(25).endsWith(":new"));
+    }
+
+    @Test
+    public void testLoadTailTrimmed() throws Exception {
+        reader.setVariable(LineReader.HISTORY_FILE, Paths.get("test"));
+        reader.setVariable(LineReader.HISTORY_SIZE, 10);
+        reader.setVariable(LineReader.HISTORY_FILE_SIZE, 20);
+        reader.unsetOpt(LineReader.Option.HISTORY_INCREMENTAL);
+        StringBuilder sb = new StringBuilder();
+        for (int i = 0; i < 25; i++) {
+            sb.append(1000 + i).append(":cmd").append(i).append("\n");
+        }
+        Files.write(Paths.get("test"), sb.toString().getBytes(StandardCharsets.UTF_8));
+
+        // the lines which were not loaded are counted
+        DefaultHistory history = new DefaultHistory(reader);
+        history.add("new");
+        history.save();
+        List<String> lines = Files.readAllLines(Paths.get("test"));
+        assertEquals(20, lines.size());
+        assertTrue(lines.get(19).endsWith(":new"));
+    }
+
+    @Test
+    public void testBinaryHistory() throws Exception {
+        reader.setVariable(LineReader.HISTORY_FILE, Paths.get("test"));
+        reader.setVariable(LineReader.HISTORY_SIZE, 3000);
+        reader.setOpt(LineReader.Option.HISTORY_BINARY);
+        reader.unsetOpt(LineReader.Option.HISTORY_INCREMENTAL);
+
+        DefaultHistory history = new DefaultHistory(reader);
+        for (int i = 0; i < 2500; i++) {
+            history.add(Instant.ofEpochMilli(1000 + i), "cmd" + i + (i % 2 == 0 ? "\nx" : ""));
+        }
+        history.save();
+        history.add(Instant.ofEpochMilli(5000), "new");
+        history.save();
+        assertTrue(BinaryHistoryFile.isBinary(Paths.get("test")));
+
+        // the tail is found from the closest index record
+        reader.setVariable(LineReader.HISTORY_SIZE, 10);
+        history = new DefaultHistory(reader);
+        assertEquals(10, history.size());
+        assertEquals(2491, history.first());
+        assertEquals("cmd2492\nx", history.get(2492));
+        assertEquals("new", history.get(2500));
+        History.Entry entry = history.iterator(2493).next();
+        assertEquals(2493, entry.index());
+        assertEquals(3493, entry.time().toEpochMilli());
+    }
+
+    @Test
+    public void testBinaryHistorySavedTwice() throws Exception {
+        reader.setVariable(LineReader.HISTORY_FILE, Paths.get("test"));
+        reader.setOpt(LineReader.Option.HISTORY_BINARY);
+        reader.unsetOpt(LineReader.Option.HISTORY_INCREMENTAL);
+
+        DefaultHistory history = new DefaultHistory(reader);
+        history.add(Instant.ofEpochMilli(1000), "cmd0");
+        history.save();
+
+        // the entries are appended to the existing file
+        history = new DefaultHistory(reader);
+        history.add(Instant.ofEpochMilli(1001), "cmd1");
+        history.save();
+        history.add(Instant.ofEpochMilli(1002), "cmd2");
+        history.save();
+
+        history = new DefaultHistory(reader);
+        assertEquals(3, history.size());
+        assertEquals(0, history.first());
+        for (int i = 0; i < 3; i++) {
+            History.Entry entry = history.iterator(i).next();
+            assertEquals("cmd" + i, entry.line());
+            assertEquals(1000 + i, entry.time().toEpochMilli());
+        }
+    }
+
+    @Test
+    public void testConvertToBinary() throws Exception {
+        Path text = Files.createTempFile(null, null);
+        StringBuilder sb = new StringBuilder();
+        for (int i = 0; i < 25; i++) {
+            sb.append(1000 + i).append(":cmd").append(i).append(i % 2 == 0 ? "\\nx" : "").append("\n");
+        }
+        Files.write(text, sb.toString().getBytes(StandardCharsets.UTF_8));
+        BinaryHistoryFile.convert(text, Paths.get("test"), true);
+        Files.delete(text);
+
+        reader.setVariable(LineReader.HISTORY_FILE, Paths.get("test"));
+        reader.setVariable(LineReader.HISTORY_SIZE, 10);
+        DefaultHistory history = new DefaultHistory(reader);
+        assertEquals(10, history.size());
+        assertEquals(15, history.first());
+        assertEquals("cmd24\nx", history.get(24));
+        assertEquals(1016, history.iterator(16).next().time().toEpochMilli());
+    }
+
+    @Test
+    public void testLoadShortFile() throws Exception {
+        reader.setVariable(LineReader.HISTORY_FILE, Paths.get("test"));
+        reader.unsetOpt(LineReader.Option.HISTORY_TIMESTAMPED);
+        Files.write(Paths.get("test"), "a\n\nb".getBytes(StandardCharsets.UTF_8));
+
+        DefaultHistory history = new DefaultHistory(reader);
+        assertEquals(3, history.size());
+        assertEquals("a", history.get(0));
+        assertEquals("", history.get(1));
+        assertEquals("b", history.get(2));
+    }
+
+    @Test
+    public void testLoadBadSyntax() throws Exception {
+        reader.setVariable(LineReader.HISTORY_FILE, Paths.get("test"));
+        Files.write(Paths.get("test"), "1000:ok\nnot a timestamp\n".getBytes(StandardCharsets.UTF_8));
+
+        DefaultHistory history = new DefaultHistory();
+        history.attach(reader);
+        assertEquals(0, history.size());
+        try {
+            history.load();
+            fail("Expected IllegalArgumentException");
+        } catch (IllegalArgumentException e) {
+            assertTrue(e.getMessage().startsWith("Bad history file syntax"));
+        }
+    }
+
+    @Test
+    public void testSharedHistory() throws Exception {
+        reader.setVariable(LineReader.HISTORY_FILE, Paths.get("test"));
+        reader.setOpt(LineReader.Option.HISTORY_SHARED);
+
+        DefaultHistory h1 = new DefaultHistory(reader);
+        DefaultHistory h2 = new DefaultHistory(reader);
+        h1.add("a");
+        h2.add("b");
+        h1.add("c");
+
+        assertEquals("a\nb\nc\n", lines(h1));
+        assertEquals("a\nb\n", lines(h2));
+        assertEquals(3, Files.readAllLines(Paths.get("test")).size());
+    }
+
+    @Test
+    public void testSharedHistoryCompaction() throws Exception {
+        reader.setVariable(LineReader.HISTORY_FILE, Paths.get("test"));
+        reader.setVariable(LineReader.HISTORY_FILE_SIZE, 4);
+        reader.setOpt(LineReader.Option.HISTORY_SHARED);
+
+        DefaultHistory h1 = new DefaultHistory(reader);
+        DefaultHistory h2 = new DefaultHistory(reader);
+        h2.add("first");
+        for (int i = 0; i < 6; i++) {
+            h1.add("cmd" + i);
+        }
+        // compacted when adding cmd4
+        assertEquals(5, Files.readAllLines(Paths.get("test")).size());
+        assertEquals("cmd1\ncmd2\ncmd3\ncmd4\ncmd5\n", lines(h1));
+
+        // reloaded, then compacted again
+        h2.add("last");
+        assertEquals("cmd2\ncmd3\ncmd4\ncmd5\nlast\n", lines(h2));
+        assertEquals(4, Files.readAllLines(Paths.get("test")).size());
+    }
+
+    @Test
+    public void testSharedHistoryConcurrent() throws Exception {
+        reader.setVariable(LineReader.HISTORY_FILE, Paths.get("test"));
+        reader.setOpt(LineReader.Option.HISTORY_SHARED);
+
+        int cmdsPerThread = 20;
+        int nbThreads = 4;
+        final CyclicBarrier barrier = new CyclicBarrier(nbThreads);
+        List<Thread> ts = IntStream.range(0, nbThreads)
+                .mapToObj(t -> new Thread(() -> {
+                    DefaultHistory history = new DefaultHistory(reader);
+                    try {
+                        barrier.await();
+                    } catch (InterruptedException | BrokenBarrierException e) {
+                        throw new RuntimeException(e);
+                    }
+                    IntStream.range(0, cmdsPerThread)
+                            .forEach(i -> history.add("cmd" + t + "-" + i));
+                }))
+                .collect(toList());
+        ts.forEach(Thread::start);
+        for (Thread t : ts) {
+            t.join();
+        }
+
+        List<String> lines = Files.readAllLines(Paths.get("test"));
+        assertEquals(cmdsPerThread * nbThreads, lines.size());
+    }
+
+    private static String lines(History history) {
+        StringBuilder sb = new StringBuilder();
+        for (History.Entry entry : history) {
+            sb.append(entry.line()).append("\n");
+        }
+        return sb.toString();
+    }
+
     @Test
     public void testFileHistory() throws Exception {
         reader.setVariable(LineReader.HISTORY_FILE, Paths.get("test"));
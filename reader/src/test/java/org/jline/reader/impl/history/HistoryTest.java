@@ -21,7 +21,9 @@ import java.nio.file.Files;
 import java.nio.file.Path;
 import java.time.Instant;
 import java.util.ArrayList;
+import java.util.Iterator;
 import java.util.List;
+import java.util.ListIterator;
 
 import static org.junit.Assert.assertEquals;
 import static org.junit.Assert.assertTrue;
@@ -151,6 +153,82 @@ public class HistoryTest extends ReaderTestSupport
         assertEquals("a", trimmed.get(2).line());
     }
 
+    @Test
+    public void testTrimKeepsLastOccurrence() {
+        List<History.Entry> entries = new ArrayList<>();
+        for (int i = 0; i < 1000; i++) {
+            entries.add(new DefaultHistory.EntryImpl(i, Instant.now(), "cmd " + (i % 10) + (i % 2 == 0 ? " " : "")));
+        }
+        List<History.Entry> trimmed = DefaultHistory.doTrimHistory(entries, 100);
+        assertEquals(10, trimmed.size());
+        for (int i = 0; i < 10; i++) {
+            assertEquals(990 + i, trimmed.get(i).index());
+            assertEquals(entries.get(990 + i).line(), trimmed.get(i).line());
+        }
+        assertEquals(1000, entries.size());
+    }
+
+    @Test
+    public void testCheckDuplicates() {
+        reader.setVariable(LineReader.HISTORY_SIZE, 3);
+        // the size is not read again for each entry added
+        history = new DefaultHistory(reader);
+        history.internalAdd(Instant.now(), "a", true);
+        history.internalAdd(Instant.now(), "b", true);
+        history.internalAdd(Instant.now(), " a ", true);
+        history.internalAdd(Instant.now(), "c", true);
+        history.internalAdd(Instant.now(), "d", true);
+        assertHistoryContains(1, "b", "c", "d");
+        // a has been evicted
+        history.internalAdd(Instant.now(), "a", true);
+        assertHistoryContains(2, "c", "d", "a");
+        // removal through an iterator
+        Iterator<History.Entry> it = history.reverseIterator();
+        it.next();
+        it.remove();
+        history.internalAdd(Instant.now(), "a", true);
+        assertHistoryContains(2, "c", "d", "a");
+        // replacement through an iterator, which keeps the size
+        ListIterator<History.Entry> lit = history.iterator(history.last());
+        lit.next();
+        lit.set(new DefaultHistory.EntryImpl(history.last(), Instant.now(), "e"));
+        history.internalAdd(Instant.now(), "a", true);
+        history.internalAdd(Instant.now(), "e", true);
+        assertHistoryContains(3, "d", "e", "a");
+    }
+
+    @Test
+    public void testEviction() {
+        reader.setVariable(LineReader.HISTORY_SIZE, 20);
+        for (int i = 0; i < 100; i++) {
+            history.add("line " + i);
+        }
+        assertEquals(20, history.size());
+        assertEquals(80, history.first());
+        assertEquals("line 85", history.get(85));
+
+        // remove the entries following 90, wrapping around the ring
+        ListIterator<History.Entry> it = history.iterator(90);
+        while (it.hasNext()) {
+            it.next();
+            it.remove();
+        }
+        assertEquals(10, history.size());
+        history.add("new");
+        assertEquals("new", history.get(90));
+        assertEquals(90, history.iterator(90).next().index());
+
+        reader.setVariable(LineReader.HISTORY_SIZE, 5);
+        history.add("last");
+        assertHistoryContains(87, "line 87", "line 88", "line 89", "new", "last");
+    }
+
+    @Test
+    public void testEntryTime() {
+        Instant time = Instant.ofEpochSecond(1234567890L, 123456789);
+        assertEquals(time, new DefaultHistory.EntryImpl(0, time, "a").time());
+    }
+
     @Test
     public void testAddHistoryLine() throws IOException {
         final Path histFile = Files.createTempFile(null, null);
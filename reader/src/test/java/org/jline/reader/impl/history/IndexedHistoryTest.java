@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2002-2021, the original author or authors.
+ *
+ * This software is distributable under the BSD license. See the terms of the
+ * BSD license in the documentation provided with this software.
+ *
+ * https://opensource.org/licenses/BSD-3-Clause
+ */
+package org.jline.reader.impl.history;
+
+import java.util.Iterator;
+import java.util.Random;
+
+import org.jline.reader.History;
+import org.jline.reader.LineReader;
+import org.jline.reader.impl.ReaderTestSupport;
+import org.junit.Before;
+import org.junit.Test;
+
+import static org.junit.Assert.assertEquals;
+
+/**
+ * Tests for {@link IndexedHistory}.
+ */
+public class IndexedHistoryTest extends ReaderTestSupport {
+
+    private static final String[] WORDS = { "git", "status", "commit", "Commit", "mvn", "install", "ls", "-la", "grep", "foo" };
+
+    private IndexedHistory history;
+    private DefaultHistory reference;
+
+    @Before
+    public void setUp() throws Exception {
+        super.setUp();
+        reader.setVariable(LineReader.HISTORY_SIZE, 100);
+        history = new IndexedHistory(reader);
+        reference = new DefaultHistory(reader);
+    }
+
+    private void add(String line) {
+        history.add(line);
+        reference.add(line);
+    }
+
+    private void assertSameSearches(String term) {
+        for (boolean startsWith : new boolean[] { false, true }) {
+            for (boolean caseInsensitive : new boolean[] { false, true }) {
+                for (int start = history.first(); start <= history.last() + 1; start += 7) {
+                    assertEquals(term + "/" + start,
+                            reference.searchBackwards(term, start, startsWith, caseInsensitive),
+                            history.searchBackwards(term, start, startsWith, caseInsensitive));
+                    assertEquals(term + "/" + start,
+                            reference.searchForwards(term, start, startsWith, caseInsensitive),
+                            history.searchForwards(term, start, startsWith, caseInsensitive));
+                }
+            }
+        }
+    }
+
+    @Test
+    public void testSearchWithEviction() {
+        Random random = new Random(1);
+        for (int i = 0; i < 350; i++) {
+            add(WORDS[random.nextInt(WORDS.length)] + " " + WORDS[random.nextInt(WORDS.length)] + " " + i);
+        }
+        assertEquals(100, history.size());
+        assertEquals(250, history.first());
+        for (String term : new String[] { "commit", "Commit", "t st", "git", "gi", "3", "34", "349", "nothing" }) {
+            assertSameSearches(term);
+        }
+    }
+
+    @Test
+    public void testSearch() {
+        add("foo bar");
+        add("baz");
+        add("Foobar");
+        assertEquals(2, history.searchBackwards("foo", 3, false, true));
+        assertEquals(0, history.searchBackwards("foo", 3, false, false));
+        assertEquals(0, history.searchBackwards("foo", 3, true, false));
+        assertEquals(-1, history.searchBackwards("foo", 0, false, true));
+        assertEquals(0, history.searchForwards("foo", 0, false, true));
+        assertEquals(2, history.searchForwards("foo", 1, false, true));
+        assertEquals(-1, history.searchForwards("qux", 0, false, true));
+    }
+
+    @Test
+    public void testRemoveThroughIterator() {
+        add("first command");
+        add("second command");
+        Iterator<History.Entry> it = history.reverseIterator();
+        it.next();
+        it.remove();
+        assertEquals(0, history.searchBackwards("command", 2, false, false));
+        add("third command");
+        assertEquals(1, history.searchBackwards("command", 2, false, false));
+        assertEquals("third command", history.get(1));
+    }
+
+}
@@ -17,6 +17,7 @@ import java.io.PipedInputStream;
 import java.io.PipedOutputStream;
 import java.nio.charset.StandardCharsets;
 import java.util.EnumSet;
+import java.util.concurrent.atomic.AtomicInteger;
 
 import org.jline.reader.LineReader;
 import org.jline.reader.LineReaderBuilder;
@@ -28,7 +29,9 @@ import org.jline.terminal.Attributes.LocalFlag;
 import org.jline.terminal.Attributes.OutputFlag;
 import org.jline.terminal.Cursor;
 import org.jline.terminal.Terminal;
+import org.jline.terminal.Terminal.Signal;
 import org.jline.terminal.TerminalBuilder;
+import org.jline.utils.NonBlockingInputStream;
 import org.junit.Ignore;
 import org.junit.Test;
 
@@ -78,6 +81,42 @@ public class ExternalTerminalTest {
         assertEquals("a\nb", output);
     }
 
+    @Test
+    public void testProcessInputBytes() throws IOException {
+        ByteArrayOutputStream out = new ByteArrayOutputStream();
+        LineDisciplineTerminal terminal = new LineDisciplineTerminal("foo", "ansi", out, StandardCharsets.UTF_8);
+        AtomicInteger interrupts = new AtomicInteger();
+        terminal.handle(Signal.INT, s -> interrupts.incrementAndGet());
+
+        // icrnl, isig and echo with onlcr are set by default
+        byte[] input = "xab\rcd\n\003ef€x".getBytes(StandardCharsets.UTF_8);
+        terminal.processInputBytes(input, 1, input.length - 2);
+        terminal.writer().flush();
+
+        assertEquals(1, interrupts.get());
+        assertEquals("ab\r\ncd\r\nef€", out.toString("UTF-8").replace("^C", ""));
+        byte[] buf = new byte[32];
+        int n = ((NonBlockingInputStream) terminal.input()).readBuffered(buf);
+        assertEquals("ab\ncd\nef€", new String(buf, 0, n, StandardCharsets.UTF_8));
+    }
+
+    @Test
+    public void testOverriddenByteProcessing() throws IOException {
+        ByteArrayOutputStream out = new ByteArrayOutputStream();
+        LineDisciplineTerminal terminal = new LineDisciplineTerminal("foo", "ansi", out, StandardCharsets.UTF_8) {
+            @Override
+            protected void processOutputByte(int c) throws IOException {
+                super.processOutputByte(Character.toUpperCase(c));
+            }
+        };
+
+        // every byte goes through the overridden method
+        terminal.processInputBytes("ab\r".getBytes(StandardCharsets.UTF_8));
+        terminal.writer().print("cd");
+        terminal.writer().flush();
+        assertEquals("AB\r\nCD", out.toString("UTF-8"));
+    }
+
     @Test
     @Ignore("This test very often fails on Travis CI")
     public void testInterrupt() throws Exception {
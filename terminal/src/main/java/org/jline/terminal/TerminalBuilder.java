@@ -59,6 +59,7 @@ public final class TerminalBuilder {
     public static final String PROP_NON_BLOCKING_READS = "org.jline.terminal.pty.nonBlockingReads";
     public static final String PROP_COLOR_DISTANCE = "org.jline.utils.colorDistance";
     public static final String PROP_DISABLE_ALTERNATE_CHARSET = "org.jline.utils.disableAlternateCharset";
+    public static final String PROP_CELL_DISPLAY = "org.jline.utils.cellDisplay";
 
     /**
      * Returns the default system terminal.
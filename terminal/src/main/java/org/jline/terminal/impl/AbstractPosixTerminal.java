@@ -55,19 +55,36 @@ public abstract class AbstractPosixTerminal extends AbstractTerminal {
         }
     }
 
-    public Size getSize() {
-        try {
-            return pty.getSize();
-        } catch (IOException e) {
-            throw new IOError(e);
+    @Override
+    protected void setAttributes(Attributes attr, Attributes current) {
+        if (pty instanceof AbstractPty) {
+            try {
+                ((AbstractPty) pty).setAttr(attr, current);
+            } catch (IOException e) {
+                throw new IOError(e);
+            }
+        } else {
+            setAttributes(attr);
         }
     }
 
+    public Size getSize() {
+        return getCachedSize(() -> {
+            try {
+                return pty.getSize();
+            } catch (IOException e) {
+                throw new IOError(e);
+            }
+        });
+    }
+
     public void setSize(Size size) {
         try {
             pty.setSize(size);
         } catch (IOException e) {
             throw new IOError(e);
+        } finally {
+            invalidateSize();
         }
     }
 
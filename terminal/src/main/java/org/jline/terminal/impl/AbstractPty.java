@@ -29,6 +29,14 @@ public abstract class AbstractPty implements Pty {
         doSetAttr(attr);
     }
 
+    /**
+     * Sets the attributes of the pty, which were last read as <code>current</code>.
+     */
+    public void setAttr(Attributes attr, Attributes current) throws IOException {
+        this.current = new Attributes(attr);
+        doSetAttr(attr, current);
+    }
+
     @Override
     public InputStream getSlaveInput() throws IOException {
         InputStream si = doGetSlaveInput();
@@ -41,6 +49,10 @@ public abstract class AbstractPty implements Pty {
 
     protected abstract void doSetAttr(Attributes attr) throws IOException;
 
+    protected void doSetAttr(Attributes attr, Attributes current) throws IOException {
+        doSetAttr(attr);
+    }
+
     protected abstract InputStream doGetSlaveInput() throws IOException;
 
     protected void checkInterrupted() throws InterruptedIOException {
@@ -96,10 +108,11 @@ public abstract class AbstractPty implements Pty {
                     || current.getControlChar(Attributes.ControlChar.VMIN) != 0
                     || current.getControlChar(Attributes.ControlChar.VTIME) != 1) {
                 try {
-                    Attributes attr = getAttr();
+                    Attributes prev = getAttr();
+                    Attributes attr = new Attributes(prev);
                     attr.setControlChar(Attributes.ControlChar.VMIN, 0);
                     attr.setControlChar(Attributes.ControlChar.VTIME, 1);
-                    setAttr(attr);
+                    setAttr(attr, prev);
                 } catch (IOException e) {
                     throw new IOError(e);
                 }
@@ -20,6 +20,7 @@ import java.util.Set;
 import java.util.concurrent.ConcurrentHashMap;
 import java.util.function.IntConsumer;
 import java.util.function.IntSupplier;
+import java.util.function.Supplier;
 
 import org.jline.terminal.Attributes;
 import org.jline.terminal.Attributes.ControlChar;
@@ -27,6 +28,7 @@ import org.jline.terminal.Attributes.InputFlag;
 import org.jline.terminal.Attributes.LocalFlag;
 import org.jline.terminal.Cursor;
 import org.jline.terminal.MouseEvent;
+import org.jline.terminal.Size;
 import org.jline.terminal.Terminal;
 import org.jline.utils.ColorPalette;
 import org.jline.utils.Curses;
@@ -44,10 +46,16 @@ public abstract class AbstractTerminal implements Terminal {
     protected final Set<Capability> bools = new HashSet<>();
     protected final Map<Capability, Integer> ints = new HashMap<>();
     protected final Map<Capability, String> strings = new HashMap<>();
+    protected final Map<Capability, Curses.Template> templates = new ConcurrentHashMap<>();
     protected final ColorPalette palette = new ColorPalette(this);
     protected Status status;
     protected Runnable onClose;
 
+    // Size of the terminal, cached until the terminal is resized
+    private volatile Size cachedSize;
+    private int sizeVersion;
+    private final Object sizeLock = new Object();
+
     public AbstractTerminal(String name, String type) throws IOException {
         this(name, type, null, SignalHandler.SIG_DFL);
     }
@@ -84,6 +92,9 @@ public abstract class AbstractTerminal implements Terminal {
 
     public void raise(Signal signal) {
         Objects.requireNonNull(signal);
+        if (signal == Signal.WINCH) {
+            invalidateSize();
+        }
         SignalHandler handler = handlers.get(signal);
         if (handler != SignalHandler.SIG_DFL && handler != SignalHandler.SIG_IGN) {
             handler.handle(signal);
@@ -93,6 +104,52 @@ public abstract class AbstractTerminal implements Terminal {
         }
     }
 
+    /**
+     * Discards the cached size of the terminal, so that it is read again by
+     * the next call to {@link #getSize()}.  This is done when {@link Signal#WINCH}
+     * is raised, and must be done explicitly when the terminal is resized
+     * without raising it.
+     */
+    public void invalidateSize() {
+        synchronized (sizeLock) {
+            cachedSize = null;
+            sizeVersion++;
+        }
+    }
+
+    /**
+     * Checks whether the size of the terminal can be cached, i.e. whether
+     * {@link Signal#WINCH} is raised whenever the terminal is resized.
+     */
+    protected boolean canCacheSize() {
+        return false;
+    }
+
+    /**
+     * Returns the size of the terminal, which is only read with the given
+     * supplier if it has not been cached since the last resize.
+     */
+    protected Size getCachedSize(Supplier<Size> reader) {
+        Size size = cachedSize;
+        if (size == null) {
+            int version;
+            synchronized (sizeLock) {
+                version = sizeVersion;
+            }
+            size = reader.get();
+            if (canCacheSize()) {
+                synchronized (sizeLock) {
+                    // Do not cache a size read before a resize
+                    if (version == sizeVersion) {
+                        cachedSize = size;
+                    }
+                }
+            }
+        }
+        // Sizes are mutable
+        return new Size(size.getColumns(), size.getRows());
+    }
+
     public final void close() throws IOException {
         try {
             doClose();
@@ -138,20 +195,30 @@ public abstract class AbstractTerminal implements Terminal {
         newAttr.setInputFlags(EnumSet.of(InputFlag.IXON, InputFlag.ICRNL, InputFlag.INLCR), false);
         newAttr.setControlChar(ControlChar.VMIN, 0);
         newAttr.setControlChar(ControlChar.VTIME, 1);
-        setAttributes(newAttr);
+        setAttributes(newAttr, prvAttr);
         return prvAttr;
     }
 
+    /**
+     * Sets the attributes of the terminal, which have just been read as
+     * <code>current</code>, so that implementations can avoid reading
+     * them again.  The attributes must not have been changed since.
+     */
+    protected void setAttributes(Attributes attr, Attributes current) {
+        setAttributes(attr);
+    }
+
     public boolean echo() {
         return getAttributes().getLocalFlag(LocalFlag.ECHO);
     }
 
     public boolean echo(boolean echo) {
-        Attributes attr = getAttributes();
-        boolean prev = attr.getLocalFlag(LocalFlag.ECHO);
+        Attributes current = getAttributes();
+        boolean prev = current.getLocalFlag(LocalFlag.ECHO);
         if (prev != echo) {
+            Attributes attr = new Attributes(current);
             attr.setLocalFlag(LocalFlag.ECHO, echo);
-            setAttributes(attr);
+            setAttributes(attr, current);
         }
         return prev;
     }
@@ -182,10 +249,31 @@ public abstract class AbstractTerminal implements Terminal {
         if (str == null) {
             return false;
         }
-        Curses.tputs(writer(), str, params);
+        getTemplate(capability, str).tputs(writer(), params);
         return true;
     }
 
+    /**
+     * Retrieve the compiled form of the given capability, compiling
+     * it the first time it's used or if the capability string has changed.
+     *
+     * @return the template, which interprets the capability if it can't be compiled
+     */
+    protected Curses.Template getTemplate(Capability capability, String str) {
+        Curses.Template template = templates.get(capability);
+        // identity check is enough: the string comes from the strings map
+        if (template == null || template.source() != str) {
+            try {
+                template = Curses.compile(str);
+            } catch (RuntimeException e) {
+                Log.debug("Unable to compile capability ", capability, ": ", e);
+                template = Curses.interpret(str);
+            }
+            templates.put(capability, template);
+        }
+        return template;
+    }
+
     public boolean getBooleanCapability(Capability capability) {
         return bools.contains(capability);
     }
@@ -90,7 +90,16 @@ public class ExecPty extends AbstractPty implements Pty {
 
     @Override
     protected void doSetAttr(Attributes attr) throws IOException {
-        List<String> commands = getFlagsToSet(attr, getAttr());
+        doSetAttr(attr, getAttr());
+    }
+
+    /**
+     * Only the flags differing from the given attributes are set, which
+     * saves reading the tty again when the caller has just read them.
+     */
+    @Override
+    protected void doSetAttr(Attributes attr, Attributes current) throws IOException {
+        List<String> commands = getFlagsToSet(attr, current);
         if (!commands.isEmpty()) {
             commands.add(0, OSUtils.STTY_COMMAND);
             if (!system) {
@@ -42,6 +42,12 @@ import org.jline.utils.NonBlockingReader;
  * has to happen as soon as the user hit the keyboard, and not
  * only when the application running in the terminal processes
  * the input.
+ *
+ * The bytes which need no processing are written in bulk, without going
+ * through {@link #doProcessInputByte(int)} and {@link #processOutputByte(int)},
+ * unless a subclass overrides those methods, in which case every byte goes
+ * through them as before.  Subclasses may instead override
+ * {@link #processOutputBytes(byte[], int, int)} to process the output in bulk.
  */
 public class LineDisciplineTerminal extends AbstractTerminal {
 
@@ -86,6 +92,10 @@ public class LineDisciplineTerminal extends AbstractTerminal {
     protected final Attributes attributes;
     protected final Size size;
 
+    // whether the bytes may bypass the per byte methods, which are not overridden
+    private final boolean bulkInput;
+    private final boolean bulkOutput;
+
     public LineDisciplineTerminal(String name,
                                   String type,
                                   OutputStream masterOutput,
@@ -108,9 +118,23 @@ public class LineDisciplineTerminal extends AbstractTerminal {
         this.masterOutput = masterOutput;
         this.attributes = ExecPty.doGetAttr(DEFAULT_TERMINAL_ATTRIBUTES);
         this.size = new Size(160, 50);
+        this.bulkOutput = !overrides("processOutputByte", int.class);
+        this.bulkInput = bulkOutput && !overrides("doProcessInputByte", int.class);
         parseInfoCmp();
     }
 
+    private boolean overrides(String name, Class<?>... types) {
+        for (Class<?> c = getClass(); c != LineDisciplineTerminal.class; c = c.getSuperclass()) {
+            try {
+                c.getDeclaredMethod(name, types);
+                return true;
+            } catch (NoSuchMethodException e) {
+                // look in the superclass
+            }
+        }
+        return false;
+    }
+
     public NonBlockingReader reader() {
         return slaveReader;
     }
@@ -190,8 +214,52 @@ public class LineDisciplineTerminal extends AbstractTerminal {
 
     public void processInputBytes(byte[] input, int offset, int length) throws IOException {
         boolean flushOut = false;
-        for (int i = 0; i < length; i++) {
-            flushOut |= doProcessInputByte(input[offset + i]);
+        int end = offset + length;
+        if (!bulkInput) {
+            for (int i = offset; i < end; i++) {
+                flushOut |= doProcessInputByte(input[i]);
+            }
+            slaveInputPipe.flush();
+            if (flushOut) {
+                masterOutput.flush();
+            }
+            return;
+        }
+        int i = offset;
+        while (i < end) {
+            // Read the attributes once for all the bytes up to the next special one,
+            // as raising a signal may change them
+            boolean isig = attributes.getLocalFlag(LocalFlag.ISIG);
+            int vintr = attributes.getControlChar(ControlChar.VINTR);
+            int vquit = attributes.getControlChar(ControlChar.VQUIT);
+            int vsusp = attributes.getControlChar(ControlChar.VSUSP);
+            int vstatus = attributes.getControlChar(ControlChar.VSTATUS);
+            boolean cr = attributes.getInputFlag(InputFlag.IGNCR) || attributes.getInputFlag(InputFlag.ICRNL);
+            boolean nl = attributes.getInputFlag(InputFlag.INLCR);
+            boolean echo = attributes.getLocalFlag(LocalFlag.ECHO);
+            if (echo) {
+                nl |= attributes.getOutputFlag(OutputFlag.OPOST) && attributes.getOutputFlag(OutputFlag.ONLCR);
+            }
+            int start = i;
+            while (i < end) {
+                int c = input[i];
+                if (c == '\r' && cr || c == '\n' && nl
+                        || isig && (c == vintr || c == vquit || c == vsusp || c == vstatus)) {
+                    break;
+                }
+                i++;
+            }
+            // The bytes before the special one go through unchanged
+            if (i > start) {
+                if (echo) {
+                    masterOutput.write(input, start, i - start);
+                    flushOut = true;
+                }
+                slaveInputPipe.write(input, start, i - start);
+            }
+            if (i < end) {
+                flushOut |= doProcessInputByte(input[i++]);
+            }
         }
         slaveInputPipe.flush();
         if (flushOut) {
@@ -253,6 +321,41 @@ public class LineDisciplineTerminal extends AbstractTerminal {
         masterOutput.write(c);
     }
 
+    /**
+     * Master output processing of several bytes.
+     * The bytes which need no processing are written at once, unless
+     * {@link #processOutputByte(int)} is overridden, in which case
+     * it is called for each byte.
+     *
+     * @param b the output bytes
+     * @param off the offset of the first byte
+     * @param len the number of bytes
+     * @throws IOException if anything wrong happens
+     */
+    protected void processOutputBytes(byte[] b, int off, int len) throws IOException {
+        if (!bulkOutput) {
+            for (int i = off; i < off + len; i++) {
+                processOutputByte(b[i]);
+            }
+            return;
+        }
+        if (!attributes.getOutputFlag(OutputFlag.OPOST) || !attributes.getOutputFlag(OutputFlag.ONLCR)) {
+            masterOutput.write(b, off, len);
+            return;
+        }
+        int end = off + len;
+        int start = off;
+        for (int i = off; i < end; i++) {
+            if (b[i] == '\n') {
+                masterOutput.write(b, start, i - start);
+                masterOutput.write('\r');
+                masterOutput.write('\n');
+                start = i + 1;
+            }
+        }
+        masterOutput.write(b, start, end - start);
+    }
+
     protected void processIOException(IOException ioException) {
         this.slaveInput.setIoException(ioException);
     }
@@ -290,9 +393,7 @@ public class LineDisciplineTerminal extends AbstractTerminal {
             } else if (len == 0) {
                 return;
             }
-            for (int i = 0 ; i < len ; i++) {
-                processOutputByte(b[off + i]);
-            }
+            processOutputBytes(b, off, len);
             flush();
         }
 
@@ -44,7 +44,8 @@ public class PosixSysTerminal extends AbstractPosixTerminal {
         parseInfoCmp();
         if (nativeSignals) {
             for (final Signal signal : Signal.values()) {
-                if (signalHandler == SignalHandler.SIG_DFL) {
+                // WINCH is always caught, so that the size of the terminal can be cached
+                if (signalHandler == SignalHandler.SIG_DFL && signal != Signal.WINCH) {
                     nativeHandlers.put(signal, Signals.registerDefault(signal.name()));
                 } else {
                     nativeHandlers.put(signal, Signals.register(signal.name(), () -> raise(signal)));
@@ -59,7 +60,7 @@ public class PosixSysTerminal extends AbstractPosixTerminal {
     public SignalHandler handle(Signal signal, SignalHandler handler) {
         SignalHandler prev = super.handle(signal, handler);
         if (prev != handler) {
-            if (handler == SignalHandler.SIG_DFL) {
+            if (handler == SignalHandler.SIG_DFL && !(signal == Signal.WINCH && canCacheSize())) {
                 Signals.registerDefault(signal.name());
             } else {
                 Signals.register(signal.name(), () -> raise(signal));
@@ -68,6 +69,11 @@ public class PosixSysTerminal extends AbstractPosixTerminal {
         return prev;
     }
 
+    @Override
+    protected boolean canCacheSize() {
+        return nativeHandlers.get(Signal.WINCH) != null;
+    }
+
     public NonBlockingReader reader() {
         return reader;
     }
@@ -15,32 +15,12 @@ import org.jline.terminal.Terminal;
 import org.jline.terminal.impl.AbstractWindowsTerminal;
 import org.jline.utils.InfoCmp.Capability;
 
-import static org.jline.utils.AttributedStyle.BG_COLOR;
-import static org.jline.utils.AttributedStyle.BG_COLOR_EXP;
-import static org.jline.utils.AttributedStyle.FG_COLOR;
-import static org.jline.utils.AttributedStyle.FG_COLOR_EXP;
-import static org.jline.utils.AttributedStyle.F_BACKGROUND;
-import static org.jline.utils.AttributedStyle.F_BACKGROUND_IND;
-import static org.jline.utils.AttributedStyle.F_BACKGROUND_RGB;
-import static org.jline.utils.AttributedStyle.F_BLINK;
-import static org.jline.utils.AttributedStyle.F_BOLD;
-import static org.jline.utils.AttributedStyle.F_CONCEAL;
-import static org.jline.utils.AttributedStyle.F_CROSSED_OUT;
-import static org.jline.utils.AttributedStyle.F_FAINT;
-import static org.jline.utils.AttributedStyle.F_FOREGROUND;
-import static org.jline.utils.AttributedStyle.F_FOREGROUND_IND;
-import static org.jline.utils.AttributedStyle.F_FOREGROUND_RGB;
-import static org.jline.utils.AttributedStyle.F_INVERSE;
-import static org.jline.utils.AttributedStyle.F_ITALIC;
-import static org.jline.utils.AttributedStyle.F_UNDERLINE;
 import static org.jline.utils.AttributedStyle.F_HIDDEN;
-import static org.jline.utils.AttributedStyle.MASK;
 import static org.jline.terminal.TerminalBuilder.PROP_DISABLE_ALTERNATE_CHARSET;
 
 public abstract class AttributedCharSequence implements CharSequence {
 
     public static final int TRUE_COLORS = 0x1000000;
-    private static final int HIGH_COLORS = 0x7FFF;
 
     public enum ForceMode {
         None,
@@ -109,163 +89,9 @@ public abstract class AttributedCharSequence implements CharSequence {
 
     public String toAnsi(int colors, ForceMode force, ColorPalette palette, String altIn, String altOut) {
         StringBuilder sb = new StringBuilder();
-        long style = 0;
-        long foreground = 0;
-        long background = 0;
-        boolean alt = false;
-        if (palette == null) {
-            palette = ColorPalette.DEFAULT;
-        }
-        for (int i = 0; i < length(); i++) {
-            char c = charAt(i);
-            if (altIn != null && altOut != null) {
-                char pc = c;
-                switch (c) {
-                    case '┘': c = 'j'; break;
-                    case '┐': c = 'k'; break;
-                    case '┌': c = 'l'; break;
-                    case '└': c = 'm'; break;
-                    case '┼': c = 'n'; break;
-                    case '─': c = 'q'; break;
-                    case '├': c = 't'; break;
-                    case '┤': c = 'u'; break;
-                    case '┴': c = 'v'; break;
-                    case '┬': c = 'w'; break;
-                    case '│': c = 'x'; break;
-                }
-                boolean oldalt = alt;
-                alt = c != pc;
-                if (oldalt ^ alt) {
-                    sb.append(alt ? altIn : altOut);
-                }
-            }
-            long  s = styleCodeAt(i) & ~F_HIDDEN; // The hidden flag does not change the ansi styles
-            if (style != s) {
-                long  d = (style ^ s) & MASK;
-                long fg = (s & F_FOREGROUND) != 0 ? s & (FG_COLOR | F_FOREGROUND) : 0;
-                long bg = (s & F_BACKGROUND) != 0 ? s & (BG_COLOR | F_BACKGROUND) : 0;
-                if (s == 0) {
-                    sb.append("\033[0m");
-                    foreground = background = 0;
-                } else {
-                    sb.append("\033[");
-                    boolean first = true;
-                    if ((d & F_ITALIC) != 0) {
-                        first = attr(sb, (s & F_ITALIC) != 0 ? "3" : "23", first);
-                    }
-                    if ((d & F_UNDERLINE) != 0) {
-                        first = attr(sb, (s & F_UNDERLINE) != 0 ? "4" : "24", first);
-                    }
-                    if ((d & F_BLINK) != 0) {
-                        first = attr(sb, (s & F_BLINK) != 0 ? "5" : "25", first);
-                    }
-                    if ((d & F_INVERSE) != 0) {
-                        first = attr(sb, (s & F_INVERSE) != 0 ? "7" : "27", first);
-                    }
-                    if ((d & F_CONCEAL) != 0) {
-                        first = attr(sb, (s & F_CONCEAL) != 0 ? "8" : "28", first);
-                    }
-                    if ((d & F_CROSSED_OUT) != 0) {
-                        first = attr(sb, (s & F_CROSSED_OUT) != 0 ? "9" : "29", first);
-                    }
-                    if (foreground != fg) {
-                        if (fg > 0) {
-                            int rounded = -1;
-                            if ((fg & F_FOREGROUND_RGB) != 0) {
-                                int r = (int)(fg >> (FG_COLOR_EXP + 16)) & 0xFF;
-                                int g = (int)(fg >> (FG_COLOR_EXP + 8)) & 0xFF;
-                                int b = (int)(fg >> FG_COLOR_EXP) & 0xFF;
-                                if (colors >= HIGH_COLORS) {
-                                    first = attr(sb, "38;2;" + r + ";" + g + ";" + b, first);
-                                } else {
-                                    rounded = palette.round(r, g, b);
-                                }
-                            } else if ((fg & F_FOREGROUND_IND) != 0) {
-                                rounded = palette.round((int)(fg >> FG_COLOR_EXP) & 0xFF);
-                            }
-                            if (rounded >= 0) {
-                                if (colors >= HIGH_COLORS && force == ForceMode.ForceTrueColors) {
-                                    int col = palette.getColor(rounded);
-                                    int r = (col >> 16) & 0xFF;
-                                    int g = (col >> 8) & 0xFF;
-                                    int b = col & 0xFF;
-                                    first = attr(sb, "38;2;" + r + ";" + g + ";" + b, first);
-                                } else if (force == ForceMode.Force256Colors || rounded >= 16) {
-                                    first = attr(sb, "38;5;" + rounded, first);
-                                } else if (rounded >= 8) {
-                                    first = attr(sb, "9" + (rounded - 8), first);
-                                    // small hack to force setting bold again after a foreground color change
-                                    d |= (s & F_BOLD);
-                                } else {
-                                    first = attr(sb, "3" + rounded, first);
-                                    // small hack to force setting bold again after a foreground color change
-                                    d |= (s & F_BOLD);
-                                }
-                            }
-                        } else {
-                            first = attr(sb, "39", first);
-                        }
-                        foreground = fg;
-                    }
-                    if (background != bg) {
-                        if (bg > 0) {
-                            int rounded = -1;
-                            if ((bg & F_BACKGROUND_RGB) != 0) {
-                                int r = (int)(bg >> (BG_COLOR_EXP + 16)) & 0xFF;
-                                int g = (int)(bg >> (BG_COLOR_EXP + 8)) & 0xFF;
-                                int b = (int)(bg >> BG_COLOR_EXP) & 0xFF;
-                                if (colors >= HIGH_COLORS) {
-                                    first = attr(sb, "48;2;" + r + ";" + g + ";" + b, first);
-                                } else {
-                                    rounded = palette.round(r, g, b);
-                                }
-                            } else if ((bg & F_BACKGROUND_IND) != 0) {
-                                rounded = palette.round((int)(bg >> BG_COLOR_EXP) & 0xFF);
-                            }
-                            if (rounded >= 0) {
-                                if (colors >= HIGH_COLORS && force == ForceMode.ForceTrueColors) {
-                                    int col = palette.getColor(rounded);
-                                    int r = (col >> 16) & 0xFF;
-                                    int g = (col >> 8) & 0xFF;
-                                    int b = col & 0xFF;
-                                    first = attr(sb, "48;2;" + r + ";" + g + ";" + b, first);
-                                } else if (force == ForceMode.Force256Colors || rounded >= 16) {
-                                    first = attr(sb, "48;5;" + rounded, first);
-                                } else if (rounded >= 8) {
-                                    first = attr(sb, "10" + (rounded - 8), first);
-                                } else {
-                                    first = attr(sb, "4" + rounded, first);
-                                }
-                            }
-                        } else {
-                            first = attr(sb, "49", first);
-                        }
-                        background = bg;
-                    }
-                    if ((d & (F_BOLD | F_FAINT)) != 0) {
-                        if (    (d & F_BOLD)  != 0 && (s & F_BOLD)  == 0
-                                || (d & F_FAINT) != 0 && (s & F_FAINT) == 0) {
-                            first = attr(sb, "22", first);
-                        }
-                        if ((d & F_BOLD) != 0 && (s & F_BOLD) != 0) {
-                            first = attr(sb, "1", first);
-                        }
-                        if ((d & F_FAINT) != 0 && (s & F_FAINT) != 0) {
-                            first = attr(sb, "2", first);
-                        }
-                    }
-                    sb.append("m");
-                }
-                style = s;
-            }
-            sb.append(c);
-        }
-        if (alt) {
-            sb.append(altOut);
-        }
-        if (style != 0) {
-            sb.append("\033[0m");
-        }
+        StyleEncoder encoder = new StyleEncoder(colors, force, palette, altIn, altOut);
+        encoder.append(sb, this);
+        encoder.reset(sb);
         return sb.toString();
     }
 
@@ -284,14 +110,6 @@ public abstract class AttributedCharSequence implements CharSequence {
         return Colors.roundRgbColor(r, g, b, max);
     }
 
-    private static boolean attr(StringBuilder sb, String s, boolean first) {
-        if (!first) {
-            sb.append(";");
-        }
-        sb.append(s);
-        return false;
-    }
-
     public abstract AttributedStyle styleAt(int index);
 
     long styleCodeAt(int index) {
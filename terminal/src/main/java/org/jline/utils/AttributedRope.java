@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2002-2021, the original author or authors.
+ *
+ * This software is distributable under the BSD license. See the terms of the
+ * BSD license in the documentation provided with this software.
+ *
+ * https://opensource.org/licenses/BSD-3-Clause
+ */
+package org.jline.utils;
+
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.List;
+
+/**
+ * Concatenation of attributed strings.
+ * Instances of this class are immutables.
+ * <p>
+ * The strings are referenced rather than copied.  Substrings which lie
+ * within one of the strings are created without any memory copy, while
+ * the others only copy their own characters.  The whole sequence is
+ * copied into a single buffer only when it is accessed as such.
+ * </p>
+ */
+public class AttributedRope extends AttributedCharSequence {
+
+    private final AttributedString[] strings;
+    // index of the first character of each string
+    private final int[] starts;
+    private final int length;
+    // string of the last accessed character, as characters are mostly read in sequence
+    private int last;
+    private AttributedString flat;
+
+    public AttributedRope(AttributedCharSequence... strings) {
+        this(Arrays.asList(strings));
+    }
+
+    public AttributedRope(List<? extends AttributedCharSequence> strings) {
+        List<AttributedString> nonEmpty = new ArrayList<>(strings.size());
+        for (AttributedCharSequence str : strings) {
+            if (str instanceof AttributedRope) {
+                nonEmpty.addAll(Arrays.asList(((AttributedRope) str).strings));
+            } else if (str instanceof AttributedString) {
+                if (str.length() > 0) {
+                    nonEmpty.add((AttributedString) str);
+                }
+            } else if (str.length() > 0) {
+                nonEmpty.add(str.toAttributedString());
+            }
+        }
+        this.strings = nonEmpty.toArray(new AttributedString[0]);
+        this.starts = new int[this.strings.length];
+        int l = 0;
+        for (int i = 0; i < this.strings.length; i++) {
+            starts[i] = l;
+            l += this.strings[i].length();
+        }
+        this.length = l;
+    }
+
+    @Override
+    public int length() {
+        return length;
+    }
+
+    @Override
+    public char charAt(int index) {
+        int i = indexOf(index);
+        AttributedString str = strings[i];
+        return str.buffer[str.start + index - starts[i]];
+    }
+
+    @Override
+    public AttributedStyle styleAt(int index) {
+        long s = styleCodeAt(index);
+        return new AttributedStyle(s, s);
+    }
+
+    @Override
+    long styleCodeAt(int index) {
+        int i = indexOf(index);
+        AttributedString str = strings[i];
+        return str.style[str.start + index - starts[i]];
+    }
+
+    @Override
+    public int codePointAt(int index) {
+        return Character.codePointAt(this, index);
+    }
+
+    @Override
+    public int codePointBefore(int index) {
+        return Character.codePointBefore(this, index);
+    }
+
+    @Override
+    public int codePointCount(int index, int length) {
+        return Character.codePointCount(this, index, index + length);
+    }
+
+    @Override
+    public AttributedString subSequence(int start, int end) {
+        if (start < 0 || end > length || start > end) {
+            throw new IndexOutOfBoundsException();
+        }
+        if (flat != null) {
+            return flat.subSequence(start, end);
+        }
+        if (start == end) {
+            return AttributedString.EMPTY;
+        }
+        int i = indexOf(start);
+        if (end <= starts[i] + strings[i].length()) {
+            return strings[i].subSequence(start - starts[i], end - starts[i]);
+        }
+        return copy(start, end);
+    }
+
+    @Override
+    protected char[] buffer() {
+        return flatten().buffer;
+    }
+
+    @Override
+    protected int offset() {
+        return flatten().start;
+    }
+
+    @Override
+    public String toString() {
+        StringBuilder sb = new StringBuilder(length);
+        for (AttributedString str : strings) {
+            sb.append(str.buffer, str.start, str.length());
+        }
+        return sb.toString();
+    }
+
+    @Override
+    public AttributedString toAttributedString() {
+        if (strings.length == 1) {
+            return strings[0];
+        }
+        return flatten();
+    }
+
+    private AttributedString flatten() {
+        if (flat == null) {
+            flat = length > 0 ? copy(0, length) : AttributedString.EMPTY;
+        }
+        return flat;
+    }
+
+    private AttributedString copy(int start, int end) {
+        char[] buffer = new char[end - start];
+        long[] style = new long[end - start];
+        int pos = start;
+        for (int i = indexOf(start); pos < end; i++) {
+            AttributedString str = strings[i];
+            int from = pos - starts[i];
+            int l = Math.min(str.length() - from, end - pos);
+            System.arraycopy(str.buffer, str.start + from, buffer, pos - start, l);
+            System.arraycopy(str.style, str.start + from, style, pos - start, l);
+            pos += l;
+        }
+        return new AttributedString(buffer, style, 0, end - start);
+    }
+
+    /**
+     * Index of the string holding the given character.
+     */
+    private int indexOf(int index) {
+        int i = last;
+        if (i < starts.length && index >= starts[i]
+                && index < (i + 1 < starts.length ? starts[i + 1] : length)) {
+            return i;
+        }
+        if (index < 0 || index >= length) {
+            throw new IndexOutOfBoundsException("Index: " + index + ", Length: " + length);
+        }
+        int lo = 0;
+        int hi = starts.length - 1;
+        while (lo < hi) {
+            int mid = (lo + hi + 1) >>> 1;
+            if (starts[mid] <= index) {
+                lo = mid;
+            } else {
+                hi = mid - 1;
+            }
+        }
+        last = lo;
+        return lo;
+    }
+
+}
@@ -9,6 +9,7 @@
 package org.jline.utils;
 
 import java.security.InvalidParameterException;
+import java.util.ArrayList;
 import java.util.Arrays;
 import java.util.List;
 import java.util.Objects;
@@ -28,6 +29,7 @@ public class AttributedString extends AttributedCharSequence {
     final long[] style;
     final int start;
     final int end;
+    private int hash;
     public static final AttributedString EMPTY = new AttributedString("");
     public static final AttributedString NEWLINE = new AttributedString("\n");
 
@@ -196,10 +198,17 @@ public class AttributedString extends AttributedCharSequence {
 
     @Override
     public int hashCode() {
-        int result = Arrays.hashCode(buffer);
-        result = 31 * result + Arrays.hashCode(style);
-        result = 31 * result + start;
-        result = 31 * result + end;
+        // only hash the visible range, so that it is consistent with equals,
+        // and cache it as the display hashes the same lines on each update
+        int result = hash;
+        if (result == 0) {
+            result = 1;
+            for (int i = start; i < end; i++) {
+                result = 31 * result + buffer[i];
+                result = 31 * result + Long.hashCode(style[i]);
+            }
+            hash = result;
+        }
         return result;
     }
 
@@ -211,15 +220,14 @@ public class AttributedString extends AttributedCharSequence {
 
     public static AttributedString join(AttributedString delimiter, Iterable<AttributedString> elements) {
         Objects.requireNonNull(elements);
-        AttributedStringBuilder sb = new AttributedStringBuilder();
-        int i = 0;
+        List<AttributedString> strings = new ArrayList<>();
         for (AttributedString str : elements) {
-            if (i++ > 0 && delimiter != null) {
-                sb.append(delimiter);
+            if (!strings.isEmpty() && delimiter != null) {
+                strings.add(delimiter);
             }
-            sb.append(str);
+            strings.add(str);
         }
-        return sb.toAttributedString();
+        return new AttributedRope(strings).toAttributedString();
     }
 
 }
@@ -156,6 +156,20 @@ public class AttributedStringBuilder extends AttributedCharSequence implements A
 
     public AttributedStringBuilder append(AttributedCharSequence str, int start, int end) {
         ensureCapacity(length + end - start);
+        if (str instanceof AttributedString && !tabs.defined()
+                && current.getMask() == 0 && current.getStyle() == 0) {
+            // nothing to change, copy the arrays at once
+            AttributedString as = (AttributedString) str;
+            System.arraycopy(as.buffer, as.start + start, buffer, length, end - start);
+            System.arraycopy(as.style, as.start + start, style, length, end - start);
+            int nl = end;
+            while (nl > start && as.buffer[as.start + nl - 1] != '\n') {
+                nl--;
+            }
+            lastLineLength = nl > start ? end - nl : lastLineLength + end - start;
+            length += end - start;
+            return this;
+        }
         for (int i = start; i < end; i++) {
             char c = str.charAt(i);
             long s = str.styleCodeAt(i) & ~current.getMask() | current.getStyle();
@@ -0,0 +1,451 @@
+/*
+ * Copyright (c) 2002-2021, the original author or authors.
+ *
+ * This software is distributable under the BSD license. See the terms of the
+ * BSD license in the documentation provided with this software.
+ *
+ * https://opensource.org/licenses/BSD-3-Clause
+ */
+package org.jline.utils;
+
+import java.util.Arrays;
+import java.util.Collections;
+import java.util.EnumMap;
+import java.util.List;
+import java.util.Map;
+import java.util.Objects;
+
+import org.jline.terminal.Terminal;
+import org.jline.utils.InfoCmp.Capability;
+
+import static org.jline.utils.AttributedStyle.F_HIDDEN;
+
+/**
+ * Full screen display rendering the lines through a grid of cells.
+ * <p>
+ * The lines are laid out in a back buffer holding a code point and a style
+ * for each cell of the screen, which is compared with the front buffer
+ * holding what the terminal currently shows.  The cells which differ are
+ * flagged in a bitmap per row and only the runs of flagged cells are written,
+ * moving the cursor with the shortest sequence available and only changing
+ * the attributes when the style of the next cell differs from the current one.
+ * </p>
+ * <p>
+ * Scrolling is detected as in {@link Display}, and done by deleting and
+ * inserting lines before the cells are compared.
+ * Lines longer than the screen are truncated instead of being wrapped, and
+ * hidden or zero width characters are ignored.  The terminal needs to support
+ * cursor addressing, see {@link #isSupported(Terminal)}.
+ * </p>
+ */
+public class CellDisplay extends Display {
+
+    /** The content of the cell on the terminal is not known */
+    private static final int UNKNOWN = -1;
+    /** Second column of a wide character */
+    private static final int WIDE = -2;
+    /** Unchanged cells between two runs are rewritten if there are less than this */
+    private static final int GAP = 4;
+    private static final int TAB_WIDTH = 8;
+
+    private final boolean useStyles;
+    private final boolean canWriteLastCell;
+    private final StringBuilder out = new StringBuilder();
+    private final Map<Capability, Curses.Template> templates = new EnumMap<>(Capability.class);
+
+    private int height;
+    private int width;
+    private int words;
+    private int[] frontChars = new int[0];
+    private long[] frontStyles = new long[0];
+    private int[] backChars = new int[0];
+    private long[] backStyles = new long[0];
+    private long[] dirty = new long[0];
+
+    private int curRow = -1;
+    private int curCol = -1;
+
+    public CellDisplay(Terminal terminal) {
+        super(terminal, true);
+        Integer maxColors = terminal.getNumericCapability(Capability.max_colors);
+        this.useStyles = maxColors != null && maxColors >= 8;
+        // the style in use on the terminal is not known
+        encoder.invalidate();
+        // writing the bottom right cell would scroll the screen
+        this.canWriteLastCell = !wrapAtEol || delayedWrapAtEol;
+    }
+
+    /**
+     * Check if the terminal provides what the cell display needs.
+     * @param terminal the terminal
+     * @return <code>true</code> if a cell display can be used on the terminal
+     */
+    public static boolean isSupported(Terminal terminal) {
+        return !Terminal.TYPE_DUMB.equals(terminal.getType())
+                && !Terminal.TYPE_DUMB_COLOR.equals(terminal.getType())
+                && terminal.getStringCapability(Capability.cursor_address) != null;
+    }
+
+    @Override
+    public void resize(int rows, int columns) {
+        super.resize(rows, columns);
+        if (rows <= 0 || columns <= 0) {
+            rows = 0;
+            columns = 0;
+        }
+        if (height != rows || width != columns) {
+            height = rows;
+            width = columns;
+            words = (columns + 63) >>> 6;
+            frontChars = new int[rows * columns];
+            frontStyles = new long[rows * columns];
+            backChars = new int[rows * columns];
+            backStyles = new long[rows * columns];
+            dirty = new long[rows * words];
+            invalidate();
+        }
+    }
+
+    @Override
+    public void reset() {
+        super.reset();
+        invalidate();
+    }
+
+    private void invalidate() {
+        Arrays.fill(frontChars, UNKNOWN);
+        curRow = -1;
+        curCol = -1;
+        encoder.invalidate();
+    }
+
+    @Override
+    public void update(List<AttributedString> newLines, int targetCursorPos, boolean flush) {
+        if (reset) {
+            encoder.reset(out);
+            tputs(Capability.clear_screen);
+            Arrays.fill(frontChars, ' ');
+            Arrays.fill(frontStyles, 0);
+            curRow = 0;
+            curCol = 0;
+            oldLines = Collections.emptyList();
+            reset = false;
+        }
+        if (canScroll && height > 0 && newLines.size() == height && oldLines.size() == height) {
+            scroll(newLines);
+        }
+        for (int row = 0; row < height; row++) {
+            layout(row, row < newLines.size() ? newLines.get(row) : AttributedString.EMPTY);
+        }
+        for (int row = 0; row < height; row++) {
+            render(row);
+        }
+        encoder.reset(out);
+        if (targetCursorPos >= 0 && height > 0) {
+            int row = Math.min(targetCursorPos / (width + 1), height - 1);
+            int col = Math.min(targetCursorPos % (width + 1), width - 1);
+            moveTo(row, col);
+        }
+        oldLines = newLines;
+        if (out.length() > 0) {
+            terminal.writer().write(out.toString());
+            out.setLength(0);
+        }
+        if (flush) {
+            terminal.flush();
+        }
+    }
+
+    private void scroll(List<AttributedString> newLines) {
+        int nbHeaders = 0;
+        int nbFooters = 0;
+        while (nbHeaders < height && Objects.equals(newLines.get(nbHeaders), oldLines.get(nbHeaders))) {
+            nbHeaders++;
+        }
+        while (nbFooters < height - nbHeaders - 1
+                && Objects.equals(newLines.get(height - nbFooters - 1), oldLines.get(height - nbFooters - 1))) {
+            nbFooters++;
+        }
+        int[] common = longestCommon(newLines.subList(nbHeaders, height - nbFooters),
+                oldLines.subList(nbHeaders, height - nbFooters));
+        if (common == null || common[2] <= 1) {
+            return;
+        }
+        int s1 = common[0];
+        int s2 = common[1];
+        int sl = common[2];
+        if (s1 < s2) {
+            int nb = s2 - s1;
+            deleteRows(nbHeaders + s1, nb);
+            if (nbFooters > 0) {
+                insertRows(nbHeaders + s1 + sl, nb);
+            }
+        } else if (s1 > s2) {
+            int nb = s1 - s2;
+            if (nbFooters > 0) {
+                deleteRows(nbHeaders + s2 + sl, nb);
+            }
+            insertRows(nbHeaders + s2, nb);
+        }
+    }
+
+    private void deleteRows(int row, int nb) {
+        moveTo(row, 0);
+        encoder.style(out, 0);
+        lines(Capability.delete_line, Capability.parm_delete_line, nb);
+        System.arraycopy(frontChars, (row + nb) * width, frontChars, row * width, (height - row - nb) * width);
+        System.arraycopy(frontStyles, (row + nb) * width, frontStyles, row * width, (height - row - nb) * width);
+        Arrays.fill(frontChars, (height - nb) * width, height * width, ' ');
+        Arrays.fill(frontStyles, (height - nb) * width, height * width, 0L);
+    }
+
+    private void insertRows(int row, int nb) {
+        moveTo(row, 0);
+        encoder.style(out, 0);
+        lines(Capability.insert_line, Capability.parm_insert_line, nb);
+        System.arraycopy(frontChars, row * width, frontChars, (row + nb) * width, (height - row - nb) * width);
+        System.arraycopy(frontStyles, row * width, frontStyles, (row + nb) * width, (height - row - nb) * width);
+        Arrays.fill(frontChars, row * width, (row + nb) * width, ' ');
+        Arrays.fill(frontStyles, row * width, (row + nb) * width, 0L);
+    }
+
+    private void lines(Capability single, Capability multi, int nb) {
+        String m = tparm(multi, nb);
+        String s = tparm(single);
+        if (m != null && (s == null || nb > 1)) {
+            out.append(m);
+        } else {
+            for (int i = 0; i < nb; i++) {
+                out.append(s);
+            }
+        }
+        // some terminals move the cursor to the first column, others do not
+        curRow = -1;
+        curCol = -1;
+    }
+
+    /**
+     * Lay out the line on the given row of the back buffer.
+     */
+    private void layout(int row, AttributedString line) {
+        int col = 0;
+        int len = line.length();
+        int i = 0;
+        while (i < len && col < width) {
+            int cp = Character.codePointAt(line, i);
+            long style = useStyles ? line.styleCodeAt(i) : 0;
+            i += Character.charCount(cp);
+            if ((style & F_HIDDEN) != 0) {
+                continue;
+            }
+            if (cp == '\t') {
+                int stop = Math.min(width, (col / TAB_WIDTH + 1) * TAB_WIDTH);
+                while (col < stop) {
+                    set(row, col++, ' ', style);
+                }
+                continue;
+            }
+            int w = WCWidth.wcwidth(cp);
+            if (w <= 0) {
+                continue;
+            }
+            if (col + w > width) {
+                break;
+            }
+            set(row, col++, cp, style);
+            if (w == 2) {
+                set(row, col++, WIDE, style);
+            }
+        }
+        while (col < width) {
+            set(row, col++, ' ', 0);
+        }
+    }
+
+    private void set(int row, int col, int cp, long style) {
+        int idx = row * width + col;
+        backChars[idx] = cp;
+        backStyles[idx] = style;
+        int word = row * words + (col >>> 6);
+        if (cp != frontChars[idx] || style != frontStyles[idx]) {
+            dirty[word] |= 1L << col;
+        } else {
+            dirty[word] &= ~(1L << col);
+        }
+    }
+
+    /**
+     * Index of the first dirty cell of the row at or after the given column, or -1.
+     */
+    private int nextDirty(int row, int col) {
+        if (col >= width) {
+            return -1;
+        }
+        int word = col >>> 6;
+        long bits = dirty[row * words + word] & (-1L << col);
+        while (true) {
+            if (bits != 0) {
+                int next = (word << 6) + Long.numberOfTrailingZeros(bits);
+                return next < width ? next : -1;
+            }
+            if (++word >= words) {
+                return -1;
+            }
+            bits = dirty[row * words + word];
+        }
+    }
+
+    /**
+     * Write the dirty cells of the given row.
+     */
+    private void render(int row) {
+        int col = nextDirty(row, 0);
+        if (col < 0) {
+            return;
+        }
+        int base = row * width;
+        // the blank cells at the end of the row can be cleared at once
+        int blank = width;
+        if (terminal.getStringCapability(Capability.clr_eol) != null) {
+            while (blank > 0 && backChars[base + blank - 1] == ' ' && backStyles[base + blank - 1] == 0) {
+                blank--;
+            }
+        }
+        int last = row == height - 1 && !canWriteLastCell ? width - 1 : width;
+        while (col >= 0) {
+            if (col >= blank) {
+                moveTo(row, col);
+                encoder.style(out, 0);
+                tputs(Capability.clr_eol);
+                for (int c = col; c < width; c++) {
+                    frontChars[base + c] = ' ';
+                    frontStyles[base + c] = 0;
+                }
+                break;
+            }
+            int end = col + 1;
+            for (int next = nextDirty(row, end); next >= 0 && next < blank && next - end < GAP; next = nextDirty(row, end)) {
+                end = next + 1;
+            }
+            end = Math.min(end, blank);
+            // do not split wide characters, neither the new ones nor the old ones
+            while (col > 0 && (backChars[base + col] == WIDE || frontChars[base + col] == WIDE)) {
+                col--;
+            }
+            while (end < width && (backChars[base + end] == WIDE || frontChars[base + end] == WIDE)) {
+                end++;
+            }
+            moveTo(row, col);
+            for (int c = col; c < end; c++) {
+                int cp = backChars[base + c];
+                if (cp == WIDE) {
+                    continue;
+                }
+                int w = c + 1 < width && backChars[base + c + 1] == WIDE ? 2 : 1;
+                if (c + w > last) {
+                    break;
+                }
+                if (curRow != row || curCol != c) {
+                    moveTo(row, c);
+                }
+                encoder.append(out, cp, backStyles[base + c]);
+                for (int k = 0; k < w; k++) {
+                    frontChars[base + c + k] = backChars[base + c + k];
+                    frontStyles[base + c + k] = backStyles[base + c + k];
+                }
+                curCol += w;
+                if (curCol >= width) {
+                    // pending wrap, the position of the cursor depends on the terminal
+                    curRow = -1;
+                    curCol = -1;
+                }
+            }
+            col = nextDirty(row, end);
+        }
+        Arrays.fill(dirty, row * words, (row + 1) * words, 0L);
+        if (last < width && (frontChars[base + last] != backChars[base + last]
+                || frontStyles[base + last] != backStyles[base + last])) {
+            dirty[row * words + (last >>> 6)] |= 1L << last;
+        }
+    }
+
+    /**
+     * Move the cursor using the shortest sequence available.
+     */
+    private void moveTo(int row, int col) {
+        if (curRow == row && curCol == col) {
+            return;
+        }
+        String best = tparm(Capability.cursor_address, row, col);
+        if (curRow == row && curCol >= 0) {
+            if (col == 0) {
+                best = shortest(best, "\r");
+            } else if (col > curCol) {
+                best = shortest(best, horizontal(Capability.cursor_right, Capability.parm_right_cursor, col - curCol));
+            } else {
+                best = shortest(best, horizontal(Capability.cursor_left, Capability.parm_left_cursor, curCol - col));
+            }
+        } else if (curRow >= 0 && curCol >= 0 && row == curRow + 1 && col == 0) {
+            best = shortest(best, "\r\n");
+        }
+        if (best != null) {
+            out.append(best);
+        }
+        curRow = row;
+        curCol = col;
+    }
+
+    private String horizontal(Capability single, Capability multi, int nb) {
+        String best = tparm(multi, nb);
+        String one = tparm(single);
+        if (one != null && (best == null || nb <= best.length())) {
+            StringBuilder sb = new StringBuilder();
+            for (int i = 0; i < nb; i++) {
+                sb.append(one);
+            }
+            best = shortest(best, sb.toString());
+        }
+        return best;
+    }
+
+    private static String shortest(String s1, String s2) {
+        if (s1 == null) {
+            return s2;
+        }
+        return s2 != null && s2.length() < s1.length() ? s2 : s1;
+    }
+
+    private void tputs(Capability capability) {
+        String str = tparm(capability);
+        if (str != null) {
+            out.append(str);
+        }
+    }
+
+    /**
+     * Expand the given capability, compiling it the first time it's used
+     * or if the capability string has changed.
+     *
+     * @return the expanded capability or <code>null</code> if the terminal
+     *         does not support it
+     */
+    private String tparm(Capability capability, Object... params) {
+        String str = terminal.getStringCapability(capability);
+        if (str == null) {
+            return null;
+        }
+        Curses.Template template = templates.get(capability);
+        // identity check is enough: the string comes from the terminal
+        if (template == null || template.source() != str) {
+            try {
+                template = Curses.compile(str);
+            } catch (RuntimeException e) {
+                Log.debug("Unable to compile capability ", capability, ": ", e);
+                template = Curses.interpret(str);
+            }
+            templates.put(capability, template);
+        }
+        return template.tputs(params);
+    }
+
+}
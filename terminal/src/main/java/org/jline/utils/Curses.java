@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2002-2018, the original author or authors.
+ * Copyright (c) 2002-2021, the original author or authors.
  *
  * This software is distributable under the BSD license. See the terms of the
  * BSD license in the documentation provided with this software.
@@ -12,6 +12,9 @@ import java.io.Flushable;
 import java.io.IOError;
 import java.io.IOException;
 import java.io.StringWriter;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.List;
 import java.util.Stack;
 
 /**
@@ -63,6 +66,31 @@ public final class Curses {
         }
     }
 
+    /**
+     * Compile the given terminal capability into a {@link Template}
+     * which can be executed repeatedly without parsing the
+     * capability string again.
+     *
+     * @param cap the capability to compile
+     * @return the compiled template or <code>null</code> if <code>cap</code> is <code>null</code>
+     * @throws IllegalArgumentException if the capability is malformed
+     */
+    public static Template compile(String cap) {
+        return cap != null ? new Compiler(cap).compile() : null;
+    }
+
+    /**
+     * Wrap the given terminal capability into a {@link Template} which
+     * interprets the capability string on each execution, for capabilities
+     * which can't be compiled.
+     *
+     * @param cap the capability to interpret
+     * @return the template or <code>null</code> if <code>cap</code> is <code>null</code>
+     */
+    public static Template interpret(String cap) {
+        return cap != null ? new Template(cap, null, null, null, 0, false) : null;
+    }
+
     private static void doTputs(Appendable out, String str, Object... params) throws IOException {
         int index = 0;
         int length = str.length();
@@ -474,4 +502,634 @@ public final class Curses {
         }
     }
 
+
+    /**
+     * A terminal capability compiled into a list of operations.
+     * Templates are immutable and can be shared between threads, but the
+     * variables set with <code>%P</code> and read with <code>%g</code> are
+     * shared by all the capabilities, as when they are interpreted, so that
+     * concurrent executions of capabilities using variables may interfere.
+     */
+    public static final class Template {
+
+        private static final ThreadLocal<int[]> ISTACK = new ThreadLocal<>();
+
+        private final String source;
+        private final int[] code;
+        private final String[] literals;
+        private final Format[] formats;
+        private final int stackSize;
+        private final boolean objects;
+
+        private Template(String source, int[] code, String[] literals, Format[] formats, int stackSize, boolean objects) {
+            this.source = source;
+            this.code = code;
+            this.literals = literals;
+            this.formats = formats;
+            this.stackSize = stackSize;
+            this.objects = objects;
+        }
+
+        /**
+         * The capability string this template has been compiled from.
+         *
+         * @return the source capability
+         */
+        public String source() {
+            return source;
+        }
+
+        /**
+         * Print the capability with the given parameters.
+         *
+         * @param params optional parameters
+         * @return the result string
+         */
+        public String tputs(Object... params) {
+            StringWriter sw = new StringWriter();
+            tputs(sw, params);
+            return sw.toString();
+        }
+
+        /**
+         * Print the capability with the given parameters.
+         *
+         * @param out the output stream
+         * @param params optional parameters
+         */
+        public void tputs(Appendable out, Object... params) {
+            try {
+                execute(out, params);
+            } catch (Exception e) {
+                throw new IOError(e);
+            }
+        }
+
+        private void execute(Appendable out, Object[] params) throws IOException {
+            if (code == null) {
+                doTputs(out, source, params);
+                return;
+            }
+            if (stackSize == 0) {
+                execute(out, params, null, null);
+                return;
+            }
+            // Integers are kept in the primitive stack, reused by the executions
+            // on the same thread, the object stack is only used by capabilities
+            // dealing with strings or variables
+            int[] istack = ISTACK.get();
+            if (istack == null || istack.length < stackSize) {
+                istack = new int[Math.max(stackSize, 16)];
+            } else {
+                // taken while in use, should the output execute another template
+                ISTACK.set(null);
+                Arrays.fill(istack, 0, stackSize, 0);
+            }
+            try {
+                execute(out, params, istack, objects ? new Object[stackSize] : null);
+            } finally {
+                ISTACK.set(istack);
+            }
+        }
+
+        private void execute(Appendable out, Object[] params, int[] istack, Object[] ostack) throws IOException {
+            int[] code = this.code;
+            int sp = 0;
+            int incr = 0;
+            int pc = 0;
+            while (pc < code.length) {
+                int op = code[pc++];
+                switch (op) {
+                    case OP_LITERAL:
+                        out.append(literals[code[pc++]]);
+                        break;
+                    case OP_PARAM: {
+                        int idx = code[pc++];
+                        Object p = params[idx];
+                        if (idx < 2 && incr > 0) {
+                            istack[sp] = toInteger(p) + incr;
+                            if (ostack != null) {
+                                ostack[sp] = null;
+                            }
+                        } else if (ostack != null && !(p instanceof Number) && !(p instanceof Boolean)) {
+                            ostack[sp] = p;
+                        } else {
+                            istack[sp] = toInteger(p);
+                            if (ostack != null) {
+                                ostack[sp] = null;
+                            }
+                        }
+                        sp++;
+                        break;
+                    }
+                    case OP_INT:
+                        istack[sp] = code[pc++];
+                        if (ostack != null) {
+                            ostack[sp] = null;
+                        }
+                        sp++;
+                        break;
+                    case OP_SET_VAR: {
+                        int idx = code[pc++];
+                        sp--;
+                        Object v = ostack[sp] != null ? ostack[sp] : Integer.valueOf(istack[sp]);
+                        if (idx < 26) {
+                            dv[idx] = v;
+                        } else {
+                            sv[idx - 26] = v;
+                        }
+                        break;
+                    }
+                    case OP_GET_VAR: {
+                        int idx = code[pc++];
+                        Object v = idx < 26 ? dv[idx] : sv[idx - 26];
+                        if (v instanceof Number || v instanceof Boolean) {
+                            istack[sp] = toInteger(v);
+                            ostack[sp] = null;
+                        } else {
+                            ostack[sp] = v;
+                        }
+                        sp++;
+                        break;
+                    }
+                    case OP_STRLEN:
+                        sp--;
+                        istack[sp] = (ostack[sp] != null ? ostack[sp].toString() : Integer.toString(istack[sp])).length();
+                        ostack[sp] = null;
+                        sp++;
+                        break;
+                    case OP_NOT:
+                        istack[sp - 1] = pop(istack, ostack, sp - 1) == 0 ? 1 : 0;
+                        break;
+                    case OP_COMPL:
+                        istack[sp - 1] = ~pop(istack, ostack, sp - 1);
+                        break;
+                    case OP_INCR:
+                        incr++;
+                        break;
+                    case OP_JUMP_IF_ZERO:
+                        if (pop(istack, ostack, --sp) == 0) {
+                            pc = code[pc];
+                        } else {
+                            pc++;
+                        }
+                        break;
+                    case OP_JUMP:
+                        pc = code[pc];
+                        break;
+                    case OP_PRINT_INT:
+                        appendInt(out, pop(istack, ostack, --sp));
+                        break;
+                    case OP_PRINT_FORMAT: {
+                        Format fmt = formats[code[pc++]];
+                        sp--;
+                        String res;
+                        if (fmt.pattern == null) {
+                            res = ostack != null && ostack[sp] != null ? (String) ostack[sp] : Integer.toString(istack[sp]);
+                            if (fmt.prec >= 0) {
+                                res = res.substring(0, fmt.prec);
+                            }
+                        } else {
+                            res = String.format(fmt.pattern, pop(istack, ostack, sp));
+                        }
+                        if (fmt.width > res.length()) {
+                            res = String.format("%" + (fmt.left ? "-" : "") + fmt.width + "s", res);
+                        }
+                        out.append(res);
+                        break;
+                    }
+                    case OP_DELAY: {
+                        int nb = code[pc++];
+                        try {
+                            if (out instanceof Flushable) {
+                                ((Flushable) out).flush();
+                            }
+                            Thread.sleep(nb);
+                        } catch (InterruptedException e) {
+                        }
+                        break;
+                    }
+                    default: {
+                        // binary operators
+                        int v2 = pop(istack, ostack, --sp);
+                        int v1 = pop(istack, ostack, sp - 1);
+                        istack[sp - 1] = binary(op, v1, v2);
+                        break;
+                    }
+                }
+            }
+        }
+
+        private static int pop(int[] istack, Object[] ostack, int sp) {
+            if (ostack != null && ostack[sp] != null) {
+                int v = toInteger(ostack[sp]);
+                ostack[sp] = null;
+                return v;
+            }
+            return istack[sp];
+        }
+
+        private static int binary(int op, int v1, int v2) {
+            switch (op) {
+                case OP_ADD: return v1 + v2;
+                case OP_SUB: return v1 - v2;
+                case OP_MUL: return v1 * v2;
+                case OP_DIV: return v1 / v2;
+                case OP_MOD: return v1 % v2;
+                case OP_AND: return v1 & v2;
+                case OP_OR: return v1 | v2;
+                case OP_XOR: return v1 ^ v2;
+                case OP_EQ: return v1 == v2 ? 1 : 0;
+                case OP_GT: return v1 > v2 ? 1 : 0;
+                case OP_LT: return v1 < v2 ? 1 : 0;
+                case OP_LAND: return v1 != 0 && v2 != 0 ? 1 : 0;
+                case OP_LOR: return v1 != 0 || v2 != 0 ? 1 : 0;
+                default: throw new IllegalStateException("Unknown operation: " + op);
+            }
+        }
+
+        private static void appendInt(Appendable out, int v) throws IOException {
+            if (v < 0) {
+                if (v == Integer.MIN_VALUE) {
+                    out.append(Integer.toString(v));
+                    return;
+                }
+                out.append('-');
+                v = -v;
+            }
+            if (v >= 10) {
+                appendInt(out, v / 10);
+            }
+            out.append((char) ('0' + v % 10));
+        }
+
+        @Override
+        public String toString() {
+            return source;
+        }
+    }
+
+    private static final int OP_LITERAL = 0;
+    private static final int OP_PARAM = 1;
+    private static final int OP_INT = 2;
+    private static final int OP_SET_VAR = 3;
+    private static final int OP_GET_VAR = 4;
+    private static final int OP_STRLEN = 5;
+    private static final int OP_NOT = 6;
+    private static final int OP_COMPL = 7;
+    private static final int OP_INCR = 8;
+    private static final int OP_JUMP_IF_ZERO = 9;
+    private static final int OP_JUMP = 10;
+    private static final int OP_PRINT_INT = 11;
+    private static final int OP_PRINT_FORMAT = 12;
+    private static final int OP_DELAY = 13;
+    private static final int OP_ADD = 20;
+    private static final int OP_SUB = 21;
+    private static final int OP_MUL = 22;
+    private static final int OP_DIV = 23;
+    private static final int OP_MOD = 24;
+    private static final int OP_AND = 25;
+    private static final int OP_OR = 26;
+    private static final int OP_XOR = 27;
+    private static final int OP_EQ = 28;
+    private static final int OP_GT = 29;
+    private static final int OP_LT = 30;
+    private static final int OP_LAND = 31;
+    private static final int OP_LOR = 32;
+
+    private static final class Format {
+        final String pattern;
+        final int width;
+        final boolean left;
+        final int prec;
+
+        Format(String pattern, int width, boolean left, int prec) {
+            this.pattern = pattern;
+            this.width = width;
+            this.left = left;
+            this.prec = prec;
+        }
+    }
+
+    /**
+     * Translates a capability string into a {@link Template}.
+     * The grammar is the same as the one handled by {@link #tputs(Appendable, String, Object...)},
+     * conditionals being turned into jumps.
+     */
+    private static final class Compiler {
+
+        private final String str;
+        private final StringBuilder literal = new StringBuilder();
+        private final List<String> literals = new ArrayList<>();
+        private final List<Format> formats = new ArrayList<>();
+        private int[] code = new int[32];
+        private int size;
+        private int pushes;
+        private boolean objects;
+        private int index;
+
+        Compiler(String str) {
+            this.str = str;
+        }
+
+        Template compile() {
+            // pending jumps of the enclosing conditionals:
+            // the location of the %t jump and the %e jumps to the end
+            Stack<List<Integer>> ifte = new Stack<>();
+            Stack<Integer> pendingThen = new Stack<>();
+            int length = str.length();
+            while (index < length) {
+                char ch = str.charAt(index++);
+                switch (ch) {
+                    case '\\':
+                        ch = str.charAt(index++);
+                        if (ch >= '0' && ch <= '7') {
+                            int val = ch - '0';
+                            for (int i = 0; i < 2; i++) {
+                                ch = str.charAt(index++);
+                                if (ch < '0' || ch > '7') {
+                                    throw new IllegalStateException();
+                                }
+                                val = val * 8 + (ch - '0');
+                            }
+                            literal.append((char) val);
+                        } else {
+                            switch (ch) {
+                                case 'e':
+                                case 'E':
+                                    literal.append((char) 27); // escape
+                                    break;
+                                case 'n':
+                                    literal.append('\n');
+                                    break;
+                                case 'r':
+                                    literal.append('\r');
+                                    break;
+                                case 't':
+                                    literal.append('\t');
+                                    break;
+                                case 'b':
+                                    literal.append('\b');
+                                    break;
+                                case 'f':
+                                    literal.append('\f');
+                                    break;
+                                case 's':
+                                    literal.append(' ');
+                                    break;
+                                case ':':
+                                case '^':
+                                case '\\':
+                                    literal.append(ch);
+                                    break;
+                                default:
+                                    throw new IllegalArgumentException();
+                            }
+                        }
+                        break;
+                    case '^':
+                        ch = str.charAt(index++);
+                        literal.append((char) (ch - '@'));
+                        break;
+                    case '%':
+                        ch = str.charAt(index++);
+                        switch (ch) {
+                            case '%':
+                                literal.append('%');
+                                break;
+                            case 'p':
+                                ch = str.charAt(index++);
+                                push(OP_PARAM, ch - '1');
+                                break;
+                            case 'P':
+                                objects = true;
+                                emit(OP_SET_VAR, variable(str.charAt(index++)));
+                                break;
+                            case 'g':
+                                objects = true;
+                                push(OP_GET_VAR, variable(str.charAt(index++)));
+                                break;
+                            case '\'':
+                                ch = str.charAt(index++);
+                                push(OP_INT, ch);
+                                ch = str.charAt(index++);
+                                if (ch != '\'') {
+                                    throw new IllegalArgumentException();
+                                }
+                                break;
+                            case '{':
+                                int start = index;
+                                while (str.charAt(index++) != '}') ;
+                                push(OP_INT, Integer.parseInt(str.substring(start, index - 1)));
+                                break;
+                            case 'l':
+                                objects = true;
+                                emit(OP_STRLEN);
+                                break;
+                            case '+': emit(OP_ADD); break;
+                            case '-': emit(OP_SUB); break;
+                            case '*': emit(OP_MUL); break;
+                            case '/': emit(OP_DIV); break;
+                            case 'm': emit(OP_MOD); break;
+                            case '&': emit(OP_AND); break;
+                            case '|': emit(OP_OR); break;
+                            case '^': emit(OP_XOR); break;
+                            case '=': emit(OP_EQ); break;
+                            case '>': emit(OP_GT); break;
+                            case '<': emit(OP_LT); break;
+                            case 'A': emit(OP_LAND); break;
+                            case 'O': emit(OP_LOR); break;
+                            case '!':
+                                emit(OP_NOT);
+                                break;
+                            case '~':
+                                emit(OP_COMPL);
+                                break;
+                            case '?':
+                                ifte.push(new ArrayList<>());
+                                pendingThen.push(-1);
+                                break;
+                            case 't':
+                                if (ifte.isEmpty() || pendingThen.peek() >= 0) {
+                                    throw new IllegalArgumentException();
+                                }
+                                emit(OP_JUMP_IF_ZERO, -1);
+                                pendingThen.set(pendingThen.size() - 1, size - 1);
+                                break;
+                            case 'e':
+                                if (ifte.isEmpty() || pendingThen.peek() < 0) {
+                                    throw new IllegalArgumentException();
+                                }
+                                emit(OP_JUMP, -1);
+                                ifte.peek().add(size - 1);
+                                code[pendingThen.pop()] = size;
+                                pendingThen.push(-1);
+                                break;
+                            case ';':
+                                if (ifte.isEmpty() || (pendingThen.peek() < 0 && ifte.peek().isEmpty())) {
+                                    throw new IllegalArgumentException();
+                                }
+                                flush();
+                                int then = pendingThen.pop();
+                                if (then >= 0) {
+                                    code[then] = size;
+                                }
+                                for (int jump : ifte.pop()) {
+                                    code[jump] = size;
+                                }
+                                break;
+                            case 'i':
+                                emit(OP_INCR);
+                                break;
+                            case 'd':
+                                emit(OP_PRINT_INT);
+                                break;
+                            default:
+                                format(ch);
+                                break;
+                        }
+                        break;
+                    case '$':
+                        if (index < length && str.charAt(index) == '<') {
+                            // We don't honour delays, just skip
+                            int nb = 0;
+                            while ((ch = str.charAt(++index)) != '>') {
+                                if (ch >= '0' && ch <= '9') {
+                                    nb = nb * 10 + (ch - '0');
+                                }
+                            }
+                            index++;
+                            emit(OP_DELAY, nb);
+                        } else {
+                            literal.append(ch);
+                        }
+                        break;
+                    default:
+                        literal.append(ch);
+                        break;
+                }
+            }
+            if (!ifte.isEmpty()) {
+                throw new IllegalArgumentException();
+            }
+            flush();
+            int[] result = new int[size];
+            System.arraycopy(code, 0, result, 0, size);
+            return new Template(str, result,
+                    literals.toArray(new String[0]),
+                    formats.toArray(new Format[0]),
+                    pushes, objects);
+        }
+
+        private int variable(char ch) {
+            if (ch >= 'a' && ch <= 'z') {
+                return ch - 'a';
+            } else if (ch >= 'A' && ch <= 'Z') {
+                return 26 + ch - 'A';
+            } else {
+                throw new IllegalArgumentException();
+            }
+        }
+
+        private void format(char ch) {
+            if (ch == ':') {
+                ch = str.charAt(index++);
+            }
+            boolean alternate = false;
+            boolean left = false;
+            boolean space = false;
+            boolean plus = false;
+            int width = 0;
+            int prec = -1;
+            while ("-+# ".indexOf(ch) >= 0) {
+                switch (ch) {
+                    case '-': left = true; break;
+                    case '+': plus = true; break;
+                    case '#': alternate = true; break;
+                    case ' ': space = true; break;
+                }
+                ch = str.charAt(index++);
+            }
+            if ("123456789".indexOf(ch) >= 0) {
+                do {
+                    width = width * 10 + (ch - '0');
+                    ch = str.charAt(index++);
+                } while ("0123456789".indexOf(ch) >= 0);
+            }
+            if (ch == '.') {
+                prec = 0;
+                ch = str.charAt(index++);
+            }
+            if ("0123456789".indexOf(ch) >= 0) {
+                do {
+                    prec = prec * 10 + (ch - '0');
+                    ch = str.charAt(index++);
+                } while ("0123456789".indexOf(ch) >= 0);
+            }
+            if ("cdoxXs".indexOf(ch) < 0) {
+                throw new IllegalArgumentException();
+            }
+            String pattern = null;
+            if (ch == 's') {
+                objects = true;
+            } else {
+                StringBuilder fmt = new StringBuilder(16);
+                fmt.append('%');
+                if (alternate) {
+                    fmt.append('#');
+                }
+                if (plus) {
+                    fmt.append('+');
+                }
+                if (space) {
+                    fmt.append(' ');
+                }
+                if (prec >= 0) {
+                    fmt.append('0');
+                    fmt.append(prec);
+                }
+                fmt.append(ch);
+                pattern = fmt.toString();
+            }
+            if (pattern != null && pattern.equals("%d") && width == 0) {
+                emit(OP_PRINT_INT);
+            } else {
+                formats.add(new Format(pattern, width, left, prec));
+                emit(OP_PRINT_FORMAT, formats.size() - 1);
+            }
+        }
+
+        private void push(int op, int arg) {
+            emit(op, arg);
+            // there's no loop, so the number of pushes bounds the stack depth
+            pushes++;
+        }
+
+        private void emit(int op, int... args) {
+            flush();
+            append(op);
+            for (int arg : args) {
+                append(arg);
+            }
+        }
+
+        private void flush() {
+            if (literal.length() > 0) {
+                literals.add(literal.toString());
+                literal.setLength(0);
+                append(OP_LITERAL);
+                append(literals.size() - 1);
+            }
+        }
+
+        private void append(int v) {
+            if (size == code.length) {
+                int[] nc = new int[code.length * 2];
+                System.arraycopy(code, 0, nc, 0, size);
+                code = nc;
+            }
+            code[size++] = v;
+        }
+    }
+
 }
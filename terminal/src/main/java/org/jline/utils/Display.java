@@ -16,6 +16,7 @@ import java.util.Objects;
 import java.util.stream.Collectors;
 
 import org.jline.terminal.Terminal;
+import org.jline.terminal.TerminalBuilder;
 import org.jline.utils.InfoCmp.Capability;
 
 /**
@@ -40,6 +41,7 @@ public class Display {
     protected final boolean wrapAtEol;
     protected final boolean delayedWrapAtEol;
     protected final boolean cursorDownIsNewLine;
+    protected final StyleEncoder encoder;
 
     public Display(Terminal terminal, boolean fullscreen) {
         this.terminal = terminal;
@@ -51,6 +53,22 @@ public class Display {
         this.delayedWrapAtEol = this.wrapAtEol
             && terminal.getBooleanCapability(Capability.eat_newline_glitch);
         this.cursorDownIsNewLine = "\n".equals(Curses.tputs(terminal.getStringCapability(Capability.cursor_down)));
+        this.encoder = new StyleEncoder(terminal);
+    }
+
+    /**
+     * Create the display of a full screen application.
+     * A {@link CellDisplay} is used when enabled with the
+     * {@link TerminalBuilder#PROP_CELL_DISPLAY} system property
+     * and supported by the terminal.
+     * @param terminal the terminal
+     * @return a new full screen display
+     */
+    public static Display fullScreen(Terminal terminal) {
+        if (Boolean.getBoolean(TerminalBuilder.PROP_CELL_DISPLAY) && CellDisplay.isSupported(terminal)) {
+            return new CellDisplay(terminal);
+        }
+        return new Display(terminal, true);
     }
 
     /**
@@ -111,6 +129,7 @@ public class Display {
      */
     public void update(List<AttributedString> newLines, int targetCursorPos, boolean flush) {
         if (reset) {
+            resetStyle();
             terminal.puts(Capability.clear_screen);
             oldLines.clear();
             cursorPos = 0;
@@ -287,6 +306,7 @@ public class Display {
                         int newLen = newLine.columnLength();
                         int nb = Math.max(oldLen, newLen) - (currentPos - curCol);
                         moveVisualCursorTo(currentPos);
+                        resetStyle();
                         if (!terminal.puts(Capability.clr_eol)) {
                             rawPrint(' ', nb);
                             cursorPos += nb;
@@ -307,13 +327,16 @@ public class Display {
                 boolean oldWrap = ! oldNL && lineIndex < oldLines.size();
                 if (newWrap != oldWrap && ! (oldWrap && cleared)) {
                     moveVisualCursorTo(lineIndex*columns1-1, newLines);
-                    if (newWrap)
+                    if (newWrap) {
                         wrapNeeded = true;
-                    else
+                    } else {
+                        resetStyle();
                         terminal.puts(Capability.clr_eol);
+                    }
                 }
             } else if (atRight) {
                 if (this.wrapAtEol) {
+                    resetStyle();
                     terminal.writer().write(" \b");
                     cursorPos++;
                 } else {
@@ -327,6 +350,7 @@ public class Display {
             moveVisualCursorTo(targetCursorPos < 0 ? currentPos : targetCursorPos, newLines);
         }
         oldLines = newLines;
+        resetStyle();
 
         if (flush) {
             terminal.flush();
@@ -334,18 +358,22 @@ public class Display {
     }
 
     protected boolean deleteLines(int nb) {
+        resetStyle();
         return perform(Capability.delete_line, Capability.parm_delete_line, nb);
     }
 
     protected boolean insertLines(int nb) {
+        resetStyle();
         return perform(Capability.insert_line, Capability.parm_insert_line, nb);
     }
 
     protected boolean insertChars(int nb) {
+        resetStyle();
         return perform(Capability.insert_character, Capability.parm_ich, nb);
     }
 
     protected boolean deleteChars(int nb) {
+        resetStyle();
         return perform(Capability.delete_character, Capability.parm_dch, nb);
     }
 
@@ -379,22 +407,64 @@ public class Display {
         return s != null ? s.length() : Integer.MAX_VALUE;
     }
 
-    private static int[] longestCommon(List<AttributedString> l1, List<AttributedString> l2) {
+    /**
+     * Find the longest run of lines common to both lists.
+     * <p>
+     * Only the runs containing a line which appears exactly once in each
+     * list are considered: such a line can only have been moved by a scroll,
+     * so the run is found by extending the match around it.  Lines are looked
+     * up by their hash, and each diagonal is only extended once around a
+     * given position, which keeps the detection linear for actual scrolls.
+     * </p>
+     * @return <code>{start1, start2, length}</code> or <code>null</code>
+     */
+    static int[] longestCommon(List<AttributedString> l1, List<AttributedString> l2) {
+        int n1 = l1.size();
+        int n2 = l2.size();
+        // for each line: occurrences in l1, occurrences in l2, last index in l2
+        Map<AttributedString, int[]> occurrences = new HashMap<>();
+        for (int j = 0; j < n2; j++) {
+            int[] occ = occurrences.computeIfAbsent(l2.get(j), k -> new int[3]);
+            occ[1]++;
+            occ[2] = j;
+        }
+        for (AttributedString line : l1) {
+            int[] occ = occurrences.get(line);
+            if (occ != null) {
+                occ[0]++;
+            }
+        }
+        // end (in l1) of the last run found on each diagonal
+        int[] covered = new int[n1 + n2];
         int start1 = 0;
         int start2 = 0;
         int max = 0;
-        for (int i = 0; i < l1.size(); i++) {
-            for (int j = 0; j < l2.size(); j++) {
-                int x = 0;
-                while (Objects.equals(l1.get(i + x), l2.get(j + x))) {
-                    x++;
-                    if (((i + x) >= l1.size()) || ((j + x) >= l2.size())) break;
-                }
-                if (x > max) {
-                    max = x;
-                    start1 = i;
-                    start2 = j;
-                }
+        for (int i = 0; i < n1; i++) {
+            int[] occ = occurrences.get(l1.get(i));
+            if (occ == null || occ[0] != 1 || occ[1] != 1) {
+                continue;
+            }
+            int j = occ[2];
+            int diagonal = j - i + n1;
+            if (i < covered[diagonal]) {
+                continue;
+            }
+            int before = 0;
+            while (i - before > 0 && j - before > 0
+                    && Objects.equals(l1.get(i - before - 1), l2.get(j - before - 1))) {
+                before++;
+            }
+            int after = 1;
+            while (i + after < n1 && j + after < n2
+                    && Objects.equals(l1.get(i + after), l2.get(j + after))) {
+                after++;
+            }
+            covered[diagonal] = i + after;
+            int x = before + after;
+            if (x > max || x == max && (i - before < start1 || i - before == start1 && j - before < start2)) {
+                max = x;
+                start1 = i - before;
+                start2 = j - before;
             }
         }
         return max != 0 ? new int[] { start1, start2, max } : null;
@@ -481,11 +551,30 @@ public class Display {
     }
 
     void rawPrint(int c) {
+        resetStyle();
         terminal.writer().write(c);
     }
 
+    /*
+     * The style of the last character is kept until something
+     * depending on the current style has to be written.
+     */
     void rawPrint(AttributedString str) {
-        str.print(terminal);
+        StringBuilder sb = new StringBuilder();
+        encoder.append(sb, str);
+        terminal.writer().write(sb.toString());
+    }
+
+    /**
+     * Switch the terminal back to the default style, before writing
+     * raw characters or erasing parts of the screen.
+     */
+    protected void resetStyle() {
+        StringBuilder sb = new StringBuilder();
+        encoder.reset(sb);
+        if (sb.length() > 0) {
+            terminal.writer().write(sb.toString());
+        }
     }
 
     public int wcwidth(String str) {
@@ -11,155 +11,212 @@ package org.jline.utils;
 import java.io.IOException;
 import java.io.InterruptedIOException;
 import java.io.OutputStream;
-import java.nio.ByteBuffer;
-
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.locks.LockSupport;
+
+/**
+ * A non blocking input stream of the bytes written to its
+ * {@link #getOutputStream() output stream}.
+ * <p>
+ * Like {@link PumpReader}, the bytes go through a single producer / single
+ * consumer ring buffer, and a blocked reader or writer is only unparked when
+ * the buffer goes from empty to non empty, or from full to non full.
+ * </p>
+ */
 public class NonBlockingPumpInputStream extends NonBlockingInputStream {
 
     private static final int DEFAULT_BUFFER_SIZE = 4096;
 
-    // Read and write buffer are backed by the same array
-    private final ByteBuffer readBuffer;
-    private final ByteBuffer writeBuffer;
+    private final byte[] buffer;
+
+    // Both positions only grow, and are wrapped when indexing the buffer
+    private volatile long readPos;
+    private volatile long writePos;
+
+    // Threads parked until the buffer is not empty, or not full
+    private volatile Thread readWaiter;
+    private volatile Thread writeWaiter;
 
     private final OutputStream output;
 
-    private boolean closed;
+    private volatile boolean closed;
 
-    private IOException ioException;
+    private volatile IOException ioException;
 
     public NonBlockingPumpInputStream() {
         this(DEFAULT_BUFFER_SIZE);
     }
 
     public NonBlockingPumpInputStream(int bufferSize) {
-        byte[] buf = new byte[bufferSize];
-        this.readBuffer = ByteBuffer.wrap(buf);
-        this.writeBuffer = ByteBuffer.wrap(buf);
+        this.buffer = new byte[bufferSize];
         this.output = new NbpOutputStream();
-        // There are no bytes available to read after initialization
-        readBuffer.limit(0);
     }
 
     public OutputStream getOutputStream() {
         return this.output;
     }
 
-    private int wait(ByteBuffer buffer, long timeout) throws IOException {
+    private int index(long pos) {
+        return (int) (pos % buffer.length);
+    }
+
+    /**
+     * Blocks until more input is available, the stream is closed or the
+     * timeout expires.
+     */
+    private int waitForInput(long timeout) throws IOException {
         boolean isInfinite = (timeout <= 0L);
         long end = 0;
         if (!isInfinite) {
-            end = System.currentTimeMillis() + timeout;
+            end = System.nanoTime() + TimeUnit.MILLISECONDS.toNanos(timeout);
         }
-        while (!closed && !buffer.hasRemaining() && (isInfinite || timeout > 0L)) {
-            // Wake up waiting readers/writers
-            notifyAll();
+        while (writePos == readPos && !closed) {
+            long nanos = 0;
+            if (!isInfinite) {
+                nanos = end - System.nanoTime();
+                if (nanos <= 0L) {
+                    return READ_EXPIRED;
+                }
+            }
+            readWaiter = Thread.currentThread();
             try {
-                wait(timeout);
-                checkIoException();
-            } catch (InterruptedException e) {
+                // Check again, as the writer may have missed the waiter
+                if (writePos == readPos && !closed && ioException == null) {
+                    if (isInfinite) {
+                        LockSupport.park(this);
+                    } else {
+                        LockSupport.parkNanos(this, nanos);
+                    }
+                }
+            } finally {
+                readWaiter = null;
+            }
+            if (Thread.interrupted()) {
                 checkIoException();
                 throw new InterruptedIOException();
             }
-            if (!isInfinite) {
-                timeout = end - System.currentTimeMillis();
-            }
+            checkIoException();
         }
-        return buffer.hasRemaining()
-                ? 0
-                : closed
-                    ? EOF
-                    : READ_EXPIRED;
+        return writePos != readPos ? 0 : EOF;
     }
 
-    private static boolean rewind(ByteBuffer buffer, ByteBuffer other) {
-        // Extend limit of other buffer if there is additional input/output available
-        if (buffer.position() > other.position()) {
-            other.limit(buffer.position());
-        }
-        // If we have reached the end of the buffer, rewind and set the new limit
-        if (buffer.position() == buffer.capacity()) {
-            buffer.rewind();
-            buffer.limit(other.position());
-            return true;
-        } else {
-            return false;
+    /**
+     * Blocks until there is new space available for buffering or the
+     * stream is closed.
+     */
+    private void waitForBufferSpace() throws IOException {
+        while (!closed) {
+            if (writePos - readPos < buffer.length) {
+                return;
+            }
+            writeWaiter = Thread.currentThread();
+            try {
+                // Check again, as the reader may have missed the waiter
+                if (writePos - readPos >= buffer.length && !closed) {
+                    LockSupport.park(this);
+                    if (Thread.interrupted()) {
+                        throw new InterruptedIOException();
+                    }
+                }
+            } finally {
+                writeWaiter = null;
+            }
         }
+        throw new ClosedException();
     }
 
-    public synchronized int available() {
-        int count = readBuffer.remaining();
-        if (writeBuffer.position() < readBuffer.position()) {
-            count += writeBuffer.position();
+    private static void unpark(Thread thread) {
+        if (thread != null) {
+            LockSupport.unpark(thread);
         }
-        return count;
+    }
+
+    public int available() {
+        return (int) (writePos - readPos);
     }
 
     @Override
     public synchronized int read(long timeout, boolean isPeek) throws IOException {
         checkIoException();
         // Blocks until more input is available or the reader is closed.
-        int res = wait(readBuffer, timeout);
+        int res = waitForInput(timeout);
         if (res >= 0) {
-            res = readBuffer.get() & 0x00FF;
+            long pos = readPos;
+            res = buffer[index(pos)] & 0x00FF;
+            if (!isPeek) {
+                readPos = pos + 1;
+                // Wake up the writer if the buffer was full
+                if (writePos - pos >= buffer.length) {
+                    unpark(writeWaiter);
+                }
+            }
         }
-        rewind(readBuffer, writeBuffer);
         return res;
     }
 
     @Override
     public synchronized int readBuffered(byte[] b) throws IOException {
         checkIoException();
-        int res = wait(readBuffer, 0L);
+        int res = waitForInput(0L);
         if (res >= 0) {
-            res = 0;
-            while (res < b.length && readBuffer.hasRemaining()) {
-                b[res++] = (byte) (readBuffer.get() & 0x00FF);
+            long pos = readPos;
+            res = (int) Math.min(b.length, writePos - pos);
+            int idx = index(pos);
+            int first = Math.min(res, buffer.length - idx);
+            System.arraycopy(buffer, idx, b, 0, first);
+            System.arraycopy(buffer, 0, b, first, res - first);
+            readPos = pos + res;
+            // Wake up the writer if the buffer was full
+            if (writePos - pos >= buffer.length) {
+                unpark(writeWaiter);
             }
         }
-        rewind(readBuffer, writeBuffer);
         return res;
     }
 
-    public synchronized void setIoException(IOException exception) {
+    public void setIoException(IOException exception) {
         this.ioException = exception;
-        notifyAll();
+        unpark(readWaiter);
     }
 
-    protected synchronized void checkIoException() throws IOException {
-        if (ioException != null) {
-            throw ioException;
+    protected void checkIoException() throws IOException {
+        IOException exception = ioException;
+        if (exception != null) {
+            throw exception;
         }
     }
 
-    synchronized void write(byte[] cbuf, int off, int len) throws IOException {
-        while (len > 0) {
-            // Blocks until there is new space available for buffering or the
-            // reader is closed.
-            if (wait(writeBuffer, 0L) == EOF) {
-                throw new ClosedException();
+    void write(byte[] cbuf, int off, int len) throws IOException {
+        synchronized (output) {
+            while (len > 0) {
+                // Blocks until there is new space available for buffering or the
+                // reader is closed.
+                waitForBufferSpace();
+                // Copy as much bytes as we can up to the end of the buffer
+                long pos = writePos;
+                int idx = index(pos);
+                int count = Math.min(len, (int) Math.min(buffer.length - (pos - readPos), buffer.length - idx));
+                System.arraycopy(cbuf, off, buffer, idx, count);
+                off += count;
+                len -= count;
+                writePos = pos + count;
+                // Wake up the reader if the buffer was empty
+                if (readPos == pos) {
+                    unpark(readWaiter);
+                }
             }
-            // Copy as much characters as we can
-            int count = Math.min(len, writeBuffer.remaining());
-            writeBuffer.put(cbuf, off, count);
-            off += count;
-            len -= count;
-            // Update buffer states and rewind if necessary
-            rewind(writeBuffer, readBuffer);
         }
     }
 
-    synchronized void flush() {
-        // Avoid waking up readers when there is nothing to read
-        if (readBuffer.hasRemaining()) {
-            // Notify readers
-            notifyAll();
-        }
+    void flush() {
+        // The reader is woken up as soon as bytes are written
     }
 
     @Override
-    public synchronized void close() throws IOException {
+    public void close() throws IOException {
         this.closed = true;
-        notifyAll();
+        unpark(readWaiter);
+        unpark(writeWaiter);
     }
 
     private class NbpOutputStream extends OutputStream {
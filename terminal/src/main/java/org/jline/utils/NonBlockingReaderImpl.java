@@ -17,7 +17,8 @@ import java.io.Reader;
  * is non-blocking; that is, reads can be performed against it that timeout
  * if no data is seen for a period of time.  This effect is achieved by having
  * a separate thread perform all non-blocking read requests and then
- * waiting on the thread to complete.  
+ * waiting on the thread to complete.  The thread reads all the characters
+ * available at once, which are then handed to the reader in bulk.
  * 
  * <p>VERY IMPORTANT NOTES
  * <ul>
@@ -33,8 +34,17 @@ public class NonBlockingReaderImpl
 {
     public static final int READ_EXPIRED = -2;
 
+    private static final int BUFFER_SIZE = 4096;
+
     private Reader in;                  // The actual input stream
-    private int    ch   = READ_EXPIRED; // Recently read character
+    /*
+     * Characters read but not yet consumed, from pos to end.  The buffer is
+     * only filled once empty, so it never needs to wrap around.  A negative
+     * end is the end of the stream, which is reported once.
+     */
+    private final char[] buffer = new char[BUFFER_SIZE];
+    private int    pos  = 0;
+    private int    end  = 0;
 
     private String      name;
     private boolean     threadIsReading      = false;
@@ -87,37 +97,48 @@ public class NonBlockingReaderImpl
 
     @Override
     public synchronized boolean ready() throws IOException {
-        return ch >= 0 || in.ready();
+        return pos < end || in.ready();
+    }
+
+    @Override
+    public synchronized int available() {
+        return Math.max(end - pos, 0);
     }
 
     @Override
-    public int readBuffered(char[] b) throws IOException {
+    public synchronized int readBuffered(char[] b) throws IOException {
         if (b == null) {
             throw new NullPointerException();
         } else if (b.length == 0) {
             return 0;
         } else if (exception != null) {
-            assert ch == READ_EXPIRED;
+            assert pos == end;
             IOException toBeThrown = exception;
             exception = null;
             throw toBeThrown;
-        } else if (ch >= -1) {
-            b[0] = (char) ch;
-            ch = READ_EXPIRED;
-            return 1;
-        } else if (!threadIsReading) {
+        } else if (pos == end && !threadIsReading) {
             return in.read(b);
         } else {
-            int c = read(-1, false);
-            if (c >= 0) {
-                b[0] = (char) c;
-                return 1;
-            } else {
+            int c = read(-1, true);
+            if (c < 0) {
+                pos = end = 0;
                 return -1;
             }
+            int n = Math.min(end - pos, b.length);
+            System.arraycopy(buffer, pos, b, 0, n);
+            pos += n;
+            return n;
         }
     }
 
+    /**
+     * Sets the number of characters read into the buffer, or -1 at the end of the stream.
+     */
+    private void filled(int n) {
+        pos = 0;
+        end = n < 0 ? -1 : n;
+    }
+
     /**
      * Attempts to read a character from the input stream for a specific
      * period of time.
@@ -130,7 +151,7 @@ public class NonBlockingReaderImpl
          * If the thread hit an IOException, we report it.
          */
         if (exception != null) {
-            assert ch == READ_EXPIRED;
+            assert pos == end;
             IOException toBeThrown = exception;
             if (!isPeek)
                 exception = null;
@@ -138,15 +159,15 @@ public class NonBlockingReaderImpl
         }
 
         /*
-         * If there was a pending character from the thread, then
-         * we send it. If the timeout is 0L or the thread was shut down
+         * If there are pending characters from the thread, then
+         * we send them. If the timeout is 0L or the thread was shut down
          * then do a local read.
          */
-        if (ch >= -1) {
+        if (pos != end) {
             assert exception == null;
         }
         else if (!isPeek && timeout <= 0L && !threadIsReading) {
-            ch = in.read();
+            filled(in.read(buffer, 0, buffer.length));
         }
         else {
             /*
@@ -178,7 +199,7 @@ public class NonBlockingReaderImpl
                 }
 
                 if (exception != null) {
-                    assert ch == READ_EXPIRED;
+                    assert pos == end;
 
                     IOException toBeThrown = exception;
                     if (!isPeek)
@@ -186,7 +207,7 @@ public class NonBlockingReaderImpl
                     throw toBeThrown;
                 }
 
-                if (ch >= -1) {
+                if (pos != end) {
                     assert exception == null;
                     break;
                 }
@@ -198,14 +219,22 @@ public class NonBlockingReaderImpl
         }
 
         /*
-         * ch is the character that was just read. Either we set it because
-         * a local read was performed or the read thread set it (or failed to
-         * change it).  We will return it's value, but if this was a peek
+         * The buffer holds the characters that were just read. Either we filled
+         * it because a local read was performed or the read thread filled it
+         * (or failed to).  We will return the first one, but if this was a peek
          * operation, then we leave it in place.
          */
-        int ret = ch;
+        if (pos == end) {
+            return READ_EXPIRED;
+        } else if (end < 0) {
+            if (!isPeek) {
+                pos = end = 0;
+            }
+            return EOF;
+        }
+        int ret = buffer[pos];
         if (!isPeek) {
-            ch = READ_EXPIRED;
+            pos++;
         }
         return ret;
     }
@@ -245,16 +274,16 @@ public class NonBlockingReaderImpl
                  * We're not shutting down, but we need to read. This cannot
                  * happen while we are holding the lock (which we aren't now).
                  */
-                int charRead = READ_EXPIRED;
+                int charsRead = 0;
                 IOException failure = null;
                 try {
-                    charRead = in.read();
-//                    if (charRead < 0) {
-//                        continue;
-//                    }
+                    /*
+                     * The buffer is empty while the thread is reading, so
+                     * the accessing thread does not look at it meanwhile.
+                     */
+                    charsRead = in.read(buffer, 0, buffer.length);
                 } catch (IOException e) {
                     failure = e;
-//                    charRead = -1;
                 }
 
                 /*
@@ -262,7 +291,9 @@ public class NonBlockingReaderImpl
                  */
                 synchronized (this) {
                     exception = failure;
-                    ch = charRead;
+                    if (failure == null) {
+                        filled(charsRead);
+                    }
                     threadIsReading = false;
                     notify();
                 }
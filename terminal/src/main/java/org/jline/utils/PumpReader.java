@@ -17,32 +17,48 @@ import java.nio.charset.Charset;
 import java.nio.charset.CharsetEncoder;
 import java.nio.charset.CoderResult;
 import java.nio.charset.CodingErrorAction;
-
+import java.util.concurrent.locks.LockSupport;
+
+/**
+ * A reader of the characters written to its {@link #getWriter() writer}.
+ * <p>
+ * The characters go through a single producer / single consumer ring buffer:
+ * the writer only advances the write position and the reader only advances
+ * the read position, so that they never share a lock.  A blocked reader or
+ * writer parks its thread, which is only unparked when the buffer goes from
+ * empty to non empty, or from full to non full.  Concurrent readers, and
+ * concurrent writers, are still serialized among themselves.
+ * </p>
+ */
 public class PumpReader extends Reader {
 
     private static final int EOF = -1;
     private static final int DEFAULT_BUFFER_SIZE = 4096;
 
-    // Read and write buffer are backed by the same array
+    private final char[] buffer;
+    // View of the buffer used to encode the characters
     private final CharBuffer readBuffer;
-    private final CharBuffer writeBuffer;
+
+    // Both positions only grow, and are wrapped when indexing the buffer
+    private volatile long readPos;
+    private volatile long writePos;
+
+    // Threads parked until the buffer is not empty, or not full
+    private volatile Thread readWaiter;
+    private volatile Thread writeWaiter;
 
     private final Writer writer;
 
-    private boolean closed;
+    private volatile boolean closed;
 
     public PumpReader() {
         this(DEFAULT_BUFFER_SIZE);
     }
 
     public PumpReader(int bufferSize) {
-        char[] buf = new char[bufferSize];
-        this.readBuffer = CharBuffer.wrap(buf);
-        this.writeBuffer = CharBuffer.wrap(buf);
+        this.buffer = new char[bufferSize];
+        this.readBuffer = CharBuffer.wrap(buffer);
         this.writer = new Writer(this);
-
-        // There are no bytes available to read after initialization
-        readBuffer.limit(0);
     }
 
     public java.io.Writer getWriter() {
@@ -53,97 +69,100 @@ public class PumpReader extends Reader {
         return new InputStream(this, charset);
     }
 
-    private boolean wait(CharBuffer buffer) throws InterruptedIOException {
-        if (closed) {
-            return false;
-        }
-
-        while (!buffer.hasRemaining()) {
-            // Wake up waiting readers/writers
-            notifyAll();
-
-            try {
-                wait();
-            } catch (InterruptedException e) {
-                throw new InterruptedIOException();
-            }
-
-            if (closed) {
-                return false;
-            }
-        }
-
-        return true;
+    private int index(long pos) {
+        return (int) (pos % buffer.length);
     }
 
     /**
      * Blocks until more input is available or the reader is closed.
      *
      * @return true if more input is available, false if the reader is closed
-     * @throws InterruptedIOException If {@link #wait()} is interrupted
+     * @throws InterruptedIOException If the thread is interrupted
      */
     private boolean waitForInput() throws InterruptedIOException {
-        return wait(readBuffer);
+        while (!closed) {
+            if (writePos != readPos) {
+                return true;
+            }
+            readWaiter = Thread.currentThread();
+            try {
+                // Check again, as the writer may have missed the waiter
+                if (writePos == readPos && !closed) {
+                    LockSupport.park(this);
+                    if (Thread.interrupted()) {
+                        throw new InterruptedIOException();
+                    }
+                }
+            } finally {
+                readWaiter = null;
+            }
+        }
+        return false;
     }
 
     /**
      * Blocks until there is new space available for buffering or the
      * reader is closed.
      *
-     * @throws InterruptedIOException If {@link #wait()} is interrupted
+     * @throws InterruptedIOException If the thread is interrupted
      * @throws ClosedException If the reader was closed
      */
     private void waitForBufferSpace() throws InterruptedIOException, ClosedException {
-        if (!wait(writeBuffer)) {
-            throw new ClosedException();
+        while (!closed) {
+            if (writePos - readPos < buffer.length) {
+                return;
+            }
+            writeWaiter = Thread.currentThread();
+            try {
+                // Check again, as the reader may have missed the waiter
+                if (writePos - readPos >= buffer.length && !closed) {
+                    LockSupport.park(this);
+                    if (Thread.interrupted()) {
+                        throw new InterruptedIOException();
+                    }
+                }
+            } finally {
+                writeWaiter = null;
+            }
         }
+        throw new ClosedException();
     }
 
-    private static boolean rewind(CharBuffer buffer, CharBuffer other) {
-        // Extend limit of other buffer if there is additional input/output available
-        if (buffer.position() > other.position()) {
-            other.limit(buffer.position());
-        }
-
-        // If we have reached the end of the buffer, rewind and set the new limit
-        if (buffer.position() == buffer.capacity()) {
-            buffer.rewind();
-            buffer.limit(other.position());
-            return true;
-        } else {
-            return false;
+    /**
+     * Makes the characters written from the given position available to the
+     * reader, waking it up if the buffer was empty.
+     */
+    private void written(long pos, int count) {
+        writePos = pos + count;
+        if (readPos == pos) {
+            unpark(readWaiter);
         }
     }
 
     /**
-     * Attempts to find additional input by rewinding the {@link #readBuffer}.
-     * Updates the {@link #writeBuffer} to make read bytes available for buffering.
-     *
-     * @return If more input is available
+     * Releases the characters read from the given position, waking up the
+     * writer if the buffer was full.
      */
-    private boolean rewindReadBuffer() {
-        return rewind(readBuffer, writeBuffer) && readBuffer.hasRemaining();
+    private void consumed(long pos, int count) {
+        readPos = pos + count;
+        if (writePos - pos >= buffer.length) {
+            unpark(writeWaiter);
+        }
     }
 
-    /**
-     * Attempts to find additional buffer space by rewinding the {@link #writeBuffer}.
-     * Updates the {@link #readBuffer} to make written bytes available to the reader.
-     */
-    private void rewindWriteBuffer() {
-        rewind(writeBuffer, readBuffer);
+    private static void unpark(Thread thread) {
+        if (thread != null) {
+            LockSupport.unpark(thread);
+        }
     }
 
     @Override
-    public synchronized boolean ready() {
-        return readBuffer.hasRemaining();
+    public boolean ready() {
+        return writePos != readPos;
     }
 
-    public synchronized int available() {
-        int count = readBuffer.remaining();
-        if (writeBuffer.position() < readBuffer.position()) {
-            count += writeBuffer.position();
-        }
-        return count;
+    public int available() {
+        return (int) (writePos - readPos);
     }
 
     @Override
@@ -152,15 +171,10 @@ public class PumpReader extends Reader {
             return EOF;
         }
 
-        int b = readBuffer.get();
-        rewindReadBuffer();
-        return b;
-    }
-
-    private int copyFromBuffer(char[] cbuf, int off, int len) {
-        len = Math.min(len, readBuffer.remaining());
-        readBuffer.get(cbuf, off, len);
-        return len;
+        long pos = readPos;
+        int c = buffer[index(pos)];
+        consumed(pos, 1);
+        return c;
     }
 
     @Override
@@ -173,12 +187,13 @@ public class PumpReader extends Reader {
             return EOF;
         }
 
-        int count = copyFromBuffer(cbuf, off, len);
-        if (rewindReadBuffer() && count < len) {
-            count += copyFromBuffer(cbuf, off + count, len - count);
-            rewindReadBuffer();
-        }
-
+        long pos = readPos;
+        int count = (int) Math.min(len, writePos - pos);
+        int idx = index(pos);
+        int first = Math.min(count, buffer.length - idx);
+        System.arraycopy(buffer, idx, cbuf, off, first);
+        System.arraycopy(buffer, 0, cbuf, off + first, count - first);
+        consumed(pos, count);
         return count;
     }
 
@@ -192,20 +207,33 @@ public class PumpReader extends Reader {
             return EOF;
         }
 
-        int count = readBuffer.read(target);
-        if (rewindReadBuffer() && target.hasRemaining()) {
-            count += readBuffer.read(target);
-            rewindReadBuffer();
-        }
-
+        long pos = readPos;
+        int count = (int) Math.min(target.remaining(), writePos - pos);
+        int idx = index(pos);
+        int first = Math.min(count, buffer.length - idx);
+        target.put(buffer, idx, first);
+        target.put(buffer, 0, count - first);
+        consumed(pos, count);
         return count;
     }
 
-    private void encodeBytes(CharsetEncoder encoder, ByteBuffer output) throws IOException {
+    private void encodeBytes(CharsetEncoder encoder, ByteBuffer output) {
+        long pos = readPos;
+        int count = (int) (writePos - pos);
+        int idx = index(pos);
+        int first = Math.min(count, buffer.length - idx);
+        readBuffer.limit(idx + first);
+        readBuffer.position(idx);
         CoderResult result = encoder.encode(readBuffer, output, false);
-        if (rewindReadBuffer() && result.isUnderflow()) {
+        int encoded = readBuffer.position() - idx;
+        if (encoded == first && first < count && result.isUnderflow()) {
+            readBuffer.limit(count - first);
+            readBuffer.position(0);
             encoder.encode(readBuffer, output, false);
-            rewindReadBuffer();
+            encoded += readBuffer.position();
+        }
+        if (encoded > 0) {
+            consumed(pos, encoded);
         }
     }
 
@@ -227,60 +255,60 @@ public class PumpReader extends Reader {
         encodeBytes(encoder, output);
     }
 
-    synchronized void write(char c) throws IOException {
-        waitForBufferSpace();
-        writeBuffer.put(c);
-        rewindWriteBuffer();
-    }
-
-    synchronized void write(char[] cbuf, int off, int len) throws IOException {
-        while (len > 0) {
+    void write(char c) throws IOException {
+        synchronized (writer) {
             waitForBufferSpace();
+            long pos = writePos;
+            buffer[index(pos)] = c;
+            written(pos, 1);
+        }
+    }
 
-            // Copy as much characters as we can
-            int count = Math.min(len, writeBuffer.remaining());
-            writeBuffer.put(cbuf, off, count);
+    void write(char[] cbuf, int off, int len) throws IOException {
+        synchronized (writer) {
+            while (len > 0) {
+                waitForBufferSpace();
 
-            off += count;
-            len -= count;
+                // Copy as much characters as we can up to the end of the buffer
+                long pos = writePos;
+                int idx = index(pos);
+                int count = Math.min(len, (int) Math.min(buffer.length - (pos - readPos), buffer.length - idx));
+                System.arraycopy(cbuf, off, buffer, idx, count);
+                written(pos, count);
 
-            // Update buffer states and rewind if necessary
-            rewindWriteBuffer();
+                off += count;
+                len -= count;
+            }
         }
     }
 
-    synchronized void write(String str, int off, int len) throws IOException {
-        char[] buf = writeBuffer.array();
-
-        while (len > 0) {
-            waitForBufferSpace();
-
-            // Copy as much characters as we can
-            int count = Math.min(len, writeBuffer.remaining());
-            // CharBuffer.put(String) doesn't use getChars so do it manually
-            str.getChars(off, off + count, buf, writeBuffer.position());
-            writeBuffer.position(writeBuffer.position() + count);
+    void write(String str, int off, int len) throws IOException {
+        synchronized (writer) {
+            while (len > 0) {
+                waitForBufferSpace();
 
-            off += count;
-            len -= count;
+                // Copy as much characters as we can up to the end of the buffer
+                long pos = writePos;
+                int idx = index(pos);
+                int count = Math.min(len, (int) Math.min(buffer.length - (pos - readPos), buffer.length - idx));
+                str.getChars(off, off + count, buffer, idx);
+                written(pos, count);
 
-            // Update buffer states and rewind if necessary
-            rewindWriteBuffer();
+                off += count;
+                len -= count;
+            }
         }
     }
 
-    synchronized void flush() {
-        // Avoid waking up readers when there is nothing to read
-        if (readBuffer.hasRemaining()) {
-            // Notify readers
-            notifyAll();
-        }
+    void flush() {
+        // The reader is woken up as soon as characters are written
     }
 
     @Override
-    public synchronized void close() throws IOException {
+    public void close() throws IOException {
         this.closed = true;
-        notifyAll();
+        unpark(readWaiter);
+        unpark(writeWaiter);
     }
 
     private static class Writer extends java.io.Writer {
@@ -146,20 +146,29 @@ public class Status {
                 terminal.puts(Capability.clr_eol);
             }
         }
+        // the style is only reset once all the lines have been written
+        StyleEncoder encoder = new StyleEncoder(terminal);
+        StringBuilder sb = new StringBuilder();
         if (border == 1 && lines.size() > 0) {
             terminal.puts(Capability.cursor_address, rows - statusSize, 0);
-            borderString.columnSubSequence(0, columns).print(terminal);
+            encoder.append(sb, borderString.columnSubSequence(0, columns));
+            terminal.writer().write(sb.toString());
         }
         for (int i = 0; i < lines.size(); i++) {
             terminal.puts(Capability.cursor_address, rows - lines.size() + i, 0);
+            sb.setLength(0);
             if (lines.get(i).length() > columns) {
                 AttributedStringBuilder asb = new AttributedStringBuilder();
                 asb.append(lines.get(i).substring(0, columns - 3)).append("...", new AttributedStyle(AttributedStyle.INVERSE));
-                asb.toAttributedString().columnSubSequence(0, columns).print(terminal);
+                encoder.append(sb, asb.toAttributedString().columnSubSequence(0, columns));
             } else {
-                lines.get(i).columnSubSequence(0, columns).print(terminal);
+                encoder.append(sb, lines.get(i).columnSubSequence(0, columns));
             }
+            terminal.writer().write(sb.toString());
         }
+        sb.setLength(0);
+        encoder.reset(sb);
+        terminal.writer().write(sb.toString());
         terminal.puts(Capability.change_scroll_region, 0, rows - 1 - statusSize);
         terminal.puts(Capability.restore_cursor);
         terminal.flush();
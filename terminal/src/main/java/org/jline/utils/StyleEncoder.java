@@ -0,0 +1,322 @@
+/*
+ * Copyright (c) 2002-2021, the original author or authors.
+ *
+ * This software is distributable under the BSD license. See the terms of the
+ * BSD license in the documentation provided with this software.
+ *
+ * https://opensource.org/licenses/BSD-3-Clause
+ */
+package org.jline.utils;
+
+import java.util.Objects;
+
+import org.jline.terminal.Terminal;
+import org.jline.terminal.impl.AbstractWindowsTerminal;
+import org.jline.utils.AttributedCharSequence.ForceMode;
+import org.jline.utils.InfoCmp.Capability;
+
+import static org.jline.utils.AttributedStyle.BG_COLOR_EXP;
+import static org.jline.utils.AttributedStyle.FG_COLOR_EXP;
+import static org.jline.utils.AttributedStyle.F_BACKGROUND;
+import static org.jline.utils.AttributedStyle.F_BACKGROUND_IND;
+import static org.jline.utils.AttributedStyle.F_BACKGROUND_RGB;
+import static org.jline.utils.AttributedStyle.F_BLINK;
+import static org.jline.utils.AttributedStyle.F_BOLD;
+import static org.jline.utils.AttributedStyle.F_CONCEAL;
+import static org.jline.utils.AttributedStyle.F_CROSSED_OUT;
+import static org.jline.utils.AttributedStyle.F_FAINT;
+import static org.jline.utils.AttributedStyle.F_FOREGROUND;
+import static org.jline.utils.AttributedStyle.F_FOREGROUND_IND;
+import static org.jline.utils.AttributedStyle.F_FOREGROUND_RGB;
+import static org.jline.utils.AttributedStyle.F_HIDDEN;
+import static org.jline.utils.AttributedStyle.F_INVERSE;
+import static org.jline.utils.AttributedStyle.F_ITALIC;
+import static org.jline.utils.AttributedStyle.F_UNDERLINE;
+import static org.jline.utils.AttributedStyle.MASK;
+
+/**
+ * Encodes attributed text into escape sequences, keeping track of the
+ * style in use on the terminal.
+ * <p>
+ * Each style change is encoded with the shortest sequence, either by
+ * changing the attributes which differ from the current style, or by
+ * resetting all attributes and setting those of the new style.  Colors
+ * are rounded according to the number of colors of the terminal, so that
+ * styles rendered the same way do not cause any output.
+ * </p>
+ */
+public class StyleEncoder {
+
+    private static final int HIGH_COLORS = 0x7FFF;
+    private static final long UNKNOWN = -1L;
+
+    private final int colors;
+    private final ForceMode force;
+    private final ColorPalette palette;
+    private final String altIn;
+    private final String altOut;
+    private final boolean plain;
+
+    private long style;
+    private boolean alt;
+
+    public StyleEncoder(Terminal terminal) {
+        Integer maxColors = terminal.getNumericCapability(Capability.max_colors);
+        this.colors = maxColors != null ? maxColors : 256;
+        this.force = AbstractWindowsTerminal.TYPE_WINDOWS_256_COLOR.equals(terminal.getType())
+                || AbstractWindowsTerminal.TYPE_WINDOWS_CONEMU.equals(terminal.getType())
+                ? ForceMode.Force256Colors : ForceMode.None;
+        this.palette = terminal.getPalette();
+        if (!AttributedCharSequence.DISABLE_ALTERNATE_CHARSET) {
+            this.altIn = Curses.tputs(terminal.getStringCapability(Capability.enter_alt_charset_mode));
+            this.altOut = Curses.tputs(terminal.getStringCapability(Capability.exit_alt_charset_mode));
+        } else {
+            this.altIn = null;
+            this.altOut = null;
+        }
+        this.plain = Terminal.TYPE_DUMB.equals(terminal.getType());
+    }
+
+    public StyleEncoder(int colors, ForceMode force, ColorPalette palette, String altIn, String altOut) {
+        this.colors = colors;
+        this.force = force;
+        this.palette = palette != null ? palette : ColorPalette.DEFAULT;
+        this.altIn = altIn;
+        this.altOut = altOut;
+        this.plain = false;
+    }
+
+    /**
+     * Forget the style in use, the next style change will reset all attributes.
+     */
+    public void invalidate() {
+        style = UNKNOWN;
+        alt = false;
+    }
+
+    /**
+     * Append the given text, switching styles as needed.
+     * The style of the last character is kept in use.
+     * @param sb the output
+     * @param str the text to append
+     */
+    public void append(StringBuilder sb, AttributedCharSequence str) {
+        for (int i = 0; i < str.length(); i++) {
+            char c = str.charAt(i);
+            c = charset(sb, c);
+            style(sb, str.styleCodeAt(i));
+            sb.append(c);
+        }
+    }
+
+    /**
+     * Append a single code point with the given style code.
+     * @param sb the output
+     * @param cp the code point
+     * @param s the style code
+     */
+    public void append(StringBuilder sb, int cp, long s) {
+        if (Character.isBmpCodePoint(cp)) {
+            char c = charset(sb, (char) cp);
+            style(sb, s);
+            sb.append(c);
+        } else {
+            // not a box drawing character, leave the alternate character set
+            charset(sb, ' ');
+            style(sb, s);
+            sb.appendCodePoint(cp);
+        }
+    }
+
+    /**
+     * Switch back to the default style and character set.
+     * @param sb the output
+     */
+    public void reset(StringBuilder sb) {
+        if (alt) {
+            sb.append(altOut);
+            alt = false;
+        }
+        style(sb, 0);
+    }
+
+    /**
+     * Switch to the given style code.
+     * @param sb the output
+     * @param s the style code
+     */
+    public void style(StringBuilder sb, long s) {
+        if (plain) {
+            return;
+        }
+        s &= ~F_HIDDEN; // The hidden flag does not change the ansi styles
+        if (style == s) {
+            return;
+        }
+        if (s == 0) {
+            sb.append("\033[0m");
+        } else {
+            StringBuilder full = new StringBuilder("0");
+            attributes(full, 0, s);
+            StringBuilder best = full;
+            if (style != UNKNOWN) {
+                StringBuilder delta = new StringBuilder();
+                attributes(delta, style, s);
+                best = delta.length() <= full.length() ? delta : full;
+            }
+            // an empty delta means both styles are rendered the same way
+            if (best.length() > 0) {
+                sb.append("\033[").append(best).append('m');
+            }
+        }
+        style = s;
+    }
+
+    private char charset(StringBuilder sb, char c) {
+        if (altIn == null || altOut == null || plain) {
+            return c;
+        }
+        char ac = alternateChar(c);
+        boolean a = ac != c;
+        if (a != alt) {
+            sb.append(a ? altIn : altOut);
+            alt = a;
+        }
+        return ac;
+    }
+
+    /**
+     * Map the box drawing characters to the alternate character set.
+     * @return the mapped character, or the given one if it has no mapping
+     */
+    static char alternateChar(char c) {
+        switch (c) {
+            case '┘': return 'j';
+            case '┐': return 'k';
+            case '┌': return 'l';
+            case '└': return 'm';
+            case '┼': return 'n';
+            case '─': return 'q';
+            case '├': return 't';
+            case '┤': return 'u';
+            case '┴': return 'v';
+            case '┬': return 'w';
+            case '│': return 'x';
+            default: return c;
+        }
+    }
+
+    /**
+     * Append the attributes changing the style from one code to another.
+     */
+    private void attributes(StringBuilder sb, long from, long s) {
+        long d = (from ^ s) & MASK;
+        if ((d & F_ITALIC) != 0) {
+            attr(sb, (s & F_ITALIC) != 0 ? "3" : "23");
+        }
+        if ((d & F_UNDERLINE) != 0) {
+            attr(sb, (s & F_UNDERLINE) != 0 ? "4" : "24");
+        }
+        if ((d & F_BLINK) != 0) {
+            attr(sb, (s & F_BLINK) != 0 ? "5" : "25");
+        }
+        if ((d & F_INVERSE) != 0) {
+            attr(sb, (s & F_INVERSE) != 0 ? "7" : "27");
+        }
+        if ((d & F_CONCEAL) != 0) {
+            attr(sb, (s & F_CONCEAL) != 0 ? "8" : "28");
+        }
+        if ((d & F_CROSSED_OUT) != 0) {
+            attr(sb, (s & F_CROSSED_OUT) != 0 ? "9" : "29");
+        }
+        String fg = foreground(s);
+        if (!Objects.equals(foreground(from), fg)) {
+            attr(sb, fg != null ? fg : "39");
+            if (fg != null && fg.length() == 2) {
+                // small hack to force setting bold again after a foreground color change
+                d |= (s & F_BOLD);
+            }
+        }
+        String bg = background(s);
+        if (!Objects.equals(background(from), bg)) {
+            attr(sb, bg != null ? bg : "49");
+        }
+        if ((d & (F_BOLD | F_FAINT)) != 0) {
+            if (    (d & F_BOLD)  != 0 && (s & F_BOLD)  == 0
+                    || (d & F_FAINT) != 0 && (s & F_FAINT) == 0) {
+                attr(sb, "22");
+            }
+            if ((d & F_BOLD) != 0 && (s & F_BOLD) != 0) {
+                attr(sb, "1");
+            }
+            if ((d & F_FAINT) != 0 && (s & F_FAINT) != 0) {
+                attr(sb, "2");
+            }
+        }
+    }
+
+    private String foreground(long s) {
+        if ((s & F_FOREGROUND) == 0) {
+            return null;
+        }
+        int rounded = -1;
+        if ((s & F_FOREGROUND_RGB) != 0) {
+            int r = (int)(s >> (FG_COLOR_EXP + 16)) & 0xFF;
+            int g = (int)(s >> (FG_COLOR_EXP + 8)) & 0xFF;
+            int b = (int)(s >> FG_COLOR_EXP) & 0xFF;
+            if (colors >= HIGH_COLORS) {
+                return "38;2;" + r + ";" + g + ";" + b;
+            }
+            rounded = palette.round(r, g, b);
+        } else if ((s & F_FOREGROUND_IND) != 0) {
+            rounded = palette.round((int)(s >> FG_COLOR_EXP) & 0xFF);
+        }
+        return color(rounded, "38", "9", "3");
+    }
+
+    private String background(long s) {
+        if ((s & F_BACKGROUND) == 0) {
+            return null;
+        }
+        int rounded = -1;
+        if ((s & F_BACKGROUND_RGB) != 0) {
+            int r = (int)(s >> (BG_COLOR_EXP + 16)) & 0xFF;
+            int g = (int)(s >> (BG_COLOR_EXP + 8)) & 0xFF;
+            int b = (int)(s >> BG_COLOR_EXP) & 0xFF;
+            if (colors >= HIGH_COLORS) {
+                return "48;2;" + r + ";" + g + ";" + b;
+            }
+            rounded = palette.round(r, g, b);
+        } else if ((s & F_BACKGROUND_IND) != 0) {
+            rounded = palette.round((int)(s >> BG_COLOR_EXP) & 0xFF);
+        }
+        return color(rounded, "48", "10", "4");
+    }
+
+    private String color(int rounded, String extended, String bright, String normal) {
+        if (rounded < 0) {
+            return null;
+        }
+        if (colors >= HIGH_COLORS && force == ForceMode.ForceTrueColors) {
+            int col = palette.getColor(rounded);
+            int r = (col >> 16) & 0xFF;
+            int g = (col >> 8) & 0xFF;
+            int b = col & 0xFF;
+            return extended + ";2;" + r + ";" + g + ";" + b;
+        } else if (force == ForceMode.Force256Colors || rounded >= 16) {
+            return extended + ";5;" + rounded;
+        } else if (rounded >= 8) {
+            return bright + (rounded - 8);
+        } else {
+            return normal + rounded;
+        }
+    }
+
+    private static void attr(StringBuilder sb, String s) {
+        if (sb.length() > 0) {
+            sb.append(";");
+        }
+        sb.append(s);
+    }
+
+}
@@ -10,9 +10,11 @@ package org.jline.terminal.impl;
 
 import org.easymock.EasyMock;
 import org.jline.terminal.Attributes;
+import org.jline.terminal.Size;
 import org.jline.terminal.Terminal.Signal;
 import org.jline.terminal.Terminal.SignalHandler;
 import org.jline.terminal.spi.Pty;
+import org.junit.Assume;
 import org.junit.Test;
 
 import java.io.ByteArrayInputStream;
@@ -67,4 +69,27 @@ public class PosixSysTerminalTest {
             assertEquals(Signal.values().length, terminal.nativeHandlers.size());
         }
     }
+
+    @Test
+    public void testCachedSize() throws Exception {
+        Pty pty = EasyMock.createNiceMock(Pty.class);
+        EasyMock.expect(pty.getAttr()).andReturn(new Attributes()).anyTimes();
+        EasyMock.expect(pty.getSlaveInput()).andReturn(new ByteArrayInputStream(new byte[0])).anyTimes();
+        EasyMock.expect(pty.getSlaveOutput()).andReturn(new ByteArrayOutputStream()).anyTimes();
+        EasyMock.expect(pty.getSize()).andReturn(new Size(80, 24)).once();
+        EasyMock.expect(pty.getSize()).andReturn(new Size(120, 40)).once();
+        EasyMock.replay(pty);
+        try (PosixSysTerminal terminal = new PosixSysTerminal(
+                "name", "ansi", pty, null, true, SignalHandler.SIG_DFL)) {
+            Assume.assumeTrue(terminal.canCacheSize());
+            // the size is only read again once the terminal has been resized
+            assertEquals(new Size(80, 24), terminal.getSize());
+            terminal.getSize().setColumns(10);
+            assertEquals(new Size(80, 24), terminal.getSize());
+            terminal.raise(Signal.WINCH);
+            assertEquals(new Size(120, 40), terminal.getSize());
+            assertEquals(new Size(120, 40), terminal.getSize());
+        }
+        EasyMock.verify(pty);
+    }
 }
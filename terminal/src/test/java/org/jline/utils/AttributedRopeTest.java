@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2002-2021, the original author or authors.
+ *
+ * This software is distributable under the BSD license. See the terms of the
+ * BSD license in the documentation provided with this software.
+ *
+ * https://opensource.org/licenses/BSD-3-Clause
+ */
+package org.jline.utils;
+
+import java.util.Collections;
+
+import org.junit.Test;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertSame;
+
+public class AttributedRopeTest {
+
+    private final AttributedString prompt = new AttributedString("> ", AttributedStyle.BOLD);
+    private final AttributedString line1 = new AttributedStringBuilder()
+            .append("select ")
+            .styled(AttributedStyle.DEFAULT.foreground(AttributedStyle.BLUE), "*")
+            .append(" from")
+            .toAttributedString();
+    private final AttributedString line2 = new AttributedString("where 〈x〉");
+
+    private AttributedString concat(AttributedString... strings) {
+        AttributedStringBuilder sb = new AttributedStringBuilder();
+        for (AttributedString str : strings) {
+            sb.append(str);
+        }
+        return sb.toAttributedString();
+    }
+
+    @Test
+    public void testConcat() {
+        AttributedRope rope = new AttributedRope(prompt, line1, AttributedString.EMPTY, AttributedString.NEWLINE, line2);
+        AttributedString expected = concat(prompt, line1, AttributedString.NEWLINE, line2);
+        assertEquals(expected.length(), rope.length());
+        assertEquals(expected.toString(), rope.toString());
+        assertEquals(expected.toAnsi(), rope.toAnsi());
+        assertEquals(expected.columnLength(), rope.columnLength());
+        for (int i = 0; i < expected.length(); i++) {
+            assertEquals(expected.charAt(i), rope.charAt(i));
+            assertEquals(expected.styleAt(i), rope.styleAt(i));
+        }
+        assertEquals(expected.columnSplitLength(6, true, false), rope.columnSplitLength(6, true, false));
+        assertEquals(expected, rope.toAttributedString());
+    }
+
+    @Test
+    public void testSubSequence() {
+        AttributedRope rope = new AttributedRope(prompt, new AttributedRope(line1, line2));
+        // within a string, the buffer is shared
+        AttributedString sub = rope.subSequence(2, 7);
+        assertEquals("selec", sub.toString());
+        assertSame(line1.buffer, sub.buffer);
+        // across strings, only the substring is copied
+        sub = rope.subSequence(1, 4);
+        assertEquals(" se", sub.toString());
+        assertEquals(3, sub.buffer.length);
+        assertEquals(AttributedStyle.BOLD, sub.styleAt(0));
+        assertEquals(AttributedStyle.DEFAULT, sub.styleAt(1));
+        assertSame(line2, new AttributedRope(AttributedString.EMPTY, line2).toAttributedString());
+    }
+
+    @Test
+    public void testJoin() {
+        AttributedString joined = AttributedString.join(new AttributedString(", "), line1, line2);
+        assertEquals("select * from, where 〈x〉", joined.toString());
+        assertEquals(concat(line1, new AttributedString(", "), line2), joined);
+        assertEquals(AttributedString.EMPTY, AttributedString.join(null, Collections.emptyList()));
+    }
+
+}
@@ -88,7 +88,7 @@ public class AttributedStringTest {
         AttributedStringBuilder sb = new AttributedStringBuilder();
         sb.styled(AttributedStyle::bold, "bold ");
         sb.styled(AttributedStyle::faint, "faint");
-        assertEquals("\u001b[1mbold \u001b[22;2mfaint\u001b[0m", sb.toAnsi());
+        assertEquals("\u001b[1mbold \u001b[0;2mfaint\u001b[0m", sb.toAnsi());
     }
 
     @Test
@@ -145,4 +145,17 @@ public class AttributedStringTest {
         assertEquals("👍", messageAgain.toString());
     }
 
+    @Test
+    public void testHashCode() {
+        AttributedString line = new AttributedStringBuilder()
+                .append("foo ")
+                .styled(AttributedStyle.BOLD, "bar")
+                .toAttributedString();
+        AttributedString bar = new AttributedStringBuilder()
+                .styled(AttributedStyle.BOLD, "bar")
+                .toAttributedString();
+        assertEquals(bar, line.subSequence(4, 7));
+        assertEquals(bar.hashCode(), line.subSequence(4, 7).hashCode());
+    }
+
 }
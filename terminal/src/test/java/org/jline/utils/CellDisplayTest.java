@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2002-2021, the original author or authors.
+ *
+ * This software is distributable under the BSD license. See the terms of the
+ * BSD license in the documentation provided with this software.
+ *
+ * https://opensource.org/licenses/BSD-3-Clause
+ */
+package org.jline.utils;
+
+import java.io.ByteArrayInputStream;
+import java.io.ByteArrayOutputStream;
+import java.io.IOException;
+import java.nio.charset.StandardCharsets;
+import java.util.ArrayList;
+import java.util.List;
+
+import org.jline.terminal.impl.DumbTerminal;
+import org.junit.Before;
+import org.junit.Test;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
+import static org.junit.Assert.assertTrue;
+
+public class CellDisplayTest {
+
+    private ByteArrayOutputStream out;
+    private CellDisplay display;
+
+    @Before
+    public void setUp() throws IOException {
+        out = new ByteArrayOutputStream();
+        DumbTerminal terminal = new DumbTerminal("dumb", "xterm-256color",
+                new ByteArrayInputStream(new byte[0]), out, StandardCharsets.UTF_8);
+        display = new CellDisplay(terminal);
+        display.resize(3, 20);
+    }
+
+    private String update(AttributedString... lines) {
+        List<AttributedString> list = new ArrayList<>();
+        for (AttributedString line : lines) {
+            list.add(line);
+        }
+        out.reset();
+        display.update(list, -1);
+        return new String(out.toByteArray(), StandardCharsets.UTF_8);
+    }
+
+    private static AttributedString str(String s) {
+        return new AttributedString(s);
+    }
+
+    @Test
+    public void testChangedCells() {
+        String full = update(str("hello world"), str("second"), str("third"));
+        assertTrue(full.contains("hello world"));
+        assertTrue(full.contains("second"));
+
+        assertEquals("", update(str("hello world"), str("second"), str("third")));
+        assertEquals("\033[1;7Hthere", update(str("hello there"), str("second"), str("third")));
+        AttributedString bold = new AttributedStringBuilder()
+                .append("hello ")
+                .styled(AttributedStyle.BOLD, "there")
+                .toAttributedString();
+        assertEquals("\033[1;7H\033[1mthere\033[0m", update(bold, str("second"), str("third")));
+    }
+
+    @Test
+    public void testScroll() {
+        update(str("line 1"), str("line 2"), str("line 3"));
+        String scroll = update(str("line 2"), str("line 3"), str("line 4"));
+        assertTrue(scroll.contains("\033[M"));
+        assertTrue(scroll.contains("4"));
+        assertFalse(scroll.contains("line 2"));
+    }
+
+    @Test
+    public void testWideCharacters() {
+        update(str("〈〈 foo"));
+        String wide = update(str("a〈〈foo"));
+        assertTrue(wide.contains("a〈〈"));
+    }
+
+}
@@ -13,6 +13,7 @@ import java.io.StringWriter;
 import org.junit.Test;
 
 import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertSame;
 
 /**
  * @author <a href="mailto:gnodet@gmail.com">Guillaume Nodet</a>
@@ -33,4 +34,45 @@ public class CursesTest {
                 Curses.tputs("\\E]4;%p1%d;rgb\\:%p2%{255}%*%{1000}%/%2.2X/%p3%{255}%*%{1000}%/%2.2X/%p4%{255}%*%{1000}%/%2.2X\\E\\\\", 123, 0xfa, 0x00, 0x89));
     }
 
+    @Test
+    public void testCompiledTputs() throws Exception {
+
+        Curses.Template cup = Curses.compile("\\E[%i%p1%d;%p2%dH");
+        assertEquals("\033[3;4H", cup.tputs(2, 3));
+        assertEquals("\033[1;1H", cup.tputs(0, 0));
+
+        Curses.Template initc = Curses.compile("\\E]4;%p1%d;rgb\\:%p2%{255}%*%{1000}%/%2.2X/%p3%{255}%*%{1000}%/%2.2X/%p4%{255}%*%{1000}%/%2.2X\\E\\\\");
+        assertEquals("\033]4;123;rgb:3F/00/22\033\\", initc.tputs(123, 0xfa, 0x00, 0x89));
+    }
+
+    @Test
+    public void testCompiledConditionals() throws Exception {
+
+        Curses.Template setaf = Curses.compile("\\E[%?%p1%{8}%<%t3%p1%d%e%p1%{16}%<%t9%p1%{8}%-%d%e38;5;%p1%d%;m");
+        assertEquals("\033[31m", setaf.tputs(1));
+        assertEquals("\033[92m", setaf.tputs(10));
+        assertEquals("\033[38;5;100m", setaf.tputs(100));
+
+        Curses.Template vars = Curses.compile("%p1%Pa%ga%ga%+%d%?%ga%{3}%>%t!%;");
+        assertEquals("4", vars.tputs(2));
+        assertEquals("10!", vars.tputs(5));
+    }
+
+    @Test
+    public void testCompiledMatchesInterpreter() throws Exception {
+
+        String[] caps = { "\\E[%p1%dA", "\\E[%p1%d;%p2%dr", "\\E[?1049h\\E[22;0;0t", "^G", "%p1%c%p2%3d%p1%-4x|", "\\E[%p1%'0'%+%d$<5>" };
+        for (String cap : caps) {
+            assertEquals(cap, Curses.tputs(cap, 65, 7), Curses.compile(cap).tputs(65, 7));
+        }
+    }
+
+    @Test
+    public void testInterpreted() throws Exception {
+        String cap = "\\E[%i%p1%d;%p2%dH";
+        Curses.Template cup = Curses.interpret(cap);
+        assertSame(cap, cup.source());
+        assertEquals("\033[3;4H", cup.tputs(2, 3));
+    }
+
 }
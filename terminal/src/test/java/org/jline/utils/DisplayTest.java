@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2002-2021, the original author or authors.
+ *
+ * This software is distributable under the BSD license. See the terms of the
+ * BSD license in the documentation provided with this software.
+ *
+ * https://opensource.org/licenses/BSD-3-Clause
+ */
+package org.jline.utils;
+
+import java.util.ArrayList;
+import java.util.List;
+
+import org.junit.Test;
+
+import static org.junit.Assert.assertArrayEquals;
+import static org.junit.Assert.assertNull;
+
+public class DisplayTest {
+
+    private static List<AttributedString> lines(String... strs) {
+        List<AttributedString> lines = new ArrayList<>();
+        for (String s : strs) {
+            lines.add(new AttributedString(s));
+        }
+        return lines;
+    }
+
+    @Test
+    public void testScrollUp() {
+        assertArrayEquals(new int[] { 1, 0, 4 },
+                Display.longestCommon(lines("a", "b", "c", "d", "e"), lines("b", "c", "d", "e", "f")));
+    }
+
+    @Test
+    public void testScrollDown() {
+        assertArrayEquals(new int[] { 0, 1, 4 },
+                Display.longestCommon(lines("a", "b", "c", "d", "e"), lines("x", "a", "b", "c", "d")));
+    }
+
+    @Test
+    public void testScrollBetweenHeaderAndFooter() {
+        // the header and footer are common, but the scrolled region is longer
+        assertArrayEquals(new int[] { 2, 1, 3 },
+                Display.longestCommon(lines("H", "a", "b", "c", "d", "F"), lines("H", "b", "c", "d", "e", "F")));
+    }
+
+    @Test
+    public void testRepeatedLines() {
+        // blank lines alone can't tell a scroll
+        assertNull(Display.longestCommon(lines("", "", "", "", ""), lines("", "", "", "", "")));
+        assertNull(Display.longestCommon(lines("a", "", "", "a"), lines("", "a", "a", "")));
+        // but they are part of the run around a line appearing once
+        assertArrayEquals(new int[] { 1, 0, 4 },
+                Display.longestCommon(lines("a", "", "", "", "b"), lines("", "", "", "b", "c")));
+    }
+
+}
@@ -4,6 +4,9 @@ import org.junit.Test;
 
 import java.io.IOException;
 import java.io.InterruptedIOException;
+import java.io.OutputStream;
+import java.io.PipedReader;
+import java.io.PipedWriter;
 import java.io.Writer;
 import java.nio.charset.StandardCharsets;
 
@@ -50,6 +53,30 @@ public class NonBlockingTest {
         assertEquals(-1, nbr.read(100));
     }
 
+    @Test
+    public void testNonBlockingReaderBulk() throws IOException {
+        PipedWriter writer = new PipedWriter();
+        NonBlockingReader nbr = NonBlocking.nonBlocking("name", new PipedReader(writer));
+        writer.write("hello world");
+        writer.flush();
+
+        // the available characters are read at once
+        assertEquals('h', nbr.read(100));
+        assertEquals(10, nbr.available());
+        assertEquals('e', nbr.peek(100));
+        char[] buf = new char[16];
+        assertEquals(10, nbr.readBuffered(buf));
+        assertEquals("ello world", new String(buf, 0, 10));
+        assertEquals(NonBlockingReader.READ_EXPIRED, nbr.read(100));
+
+        writer.write("foo");
+        writer.close();
+        assertEquals(3, nbr.readBuffered(buf));
+        assertEquals("foo", new String(buf, 0, 3));
+        assertEquals(-1, nbr.read(100));
+        nbr.shutdown();
+    }
+
     @Test
     public void testNonBlockingPumpReader() throws IOException {
         NonBlockingPumpReader nbr = NonBlocking.nonBlockingPumpReader();
@@ -107,4 +134,43 @@ public class NonBlockingTest {
         }
         assertEquals(NonBlockingInputStream.READ_EXPIRED, is.read(100));
     }
+
+    @Test
+    public void testNonBlockingPumpInputStream() throws Exception {
+        NonBlockingPumpInputStream nbis = NonBlocking.nonBlockingPumpInputStream(4);
+        OutputStream out = nbis.getOutputStream();
+
+        assertEquals(NonBlockingInputStream.READ_EXPIRED, nbis.read(100));
+        out.write(new byte[] { 1, 2, 3 });
+        assertEquals(1, nbis.read(100));
+        assertEquals(2, nbis.peek(100));
+        assertEquals(2, nbis.available());
+
+        // the writer blocks until the buffer has room for the whole array
+        Thread thread = new Thread(() -> {
+            try {
+                out.write(new byte[] { 4, 5, 6, 7, 8 });
+                out.close();
+            } catch (IOException e) {
+                throw new RuntimeException(e);
+            }
+        });
+        thread.start();
+        byte[] buf = new byte[8];
+        int n = 0;
+        while (n < 7) {
+            byte[] b = new byte[3];
+            int r = nbis.readBuffered(b);
+            if (r > 0) {
+                System.arraycopy(b, 0, buf, n, r);
+                n += r;
+            }
+        }
+        thread.join();
+        assertEquals(7, n);
+        for (int i = 0; i < n; i++) {
+            assertEquals(i + 2, buf[i]);
+        }
+        assertEquals(NonBlockingInputStream.EOF, nbis.read(100));
+    }
 }
@@ -15,6 +15,8 @@ import org.junit.Test;
 import java.io.BufferedReader;
 import java.io.IOException;
 import java.io.PrintWriter;
+import java.io.Writer;
+import java.nio.CharBuffer;
 import java.nio.charset.StandardCharsets;
 
 public class PumpReaderTest {
@@ -50,4 +52,45 @@ public class PumpReaderTest {
         assertEquals("㐀", reader.readLine());
     }
 
+    @Test
+    public void testSmallBuffer() throws Exception {
+        // the buffer is filled and drained many times, wrapping around its end
+        PumpReader pump = new PumpReader(7);
+        StringBuilder sb = new StringBuilder();
+        for (int i = 0; i < 10000; i++) {
+            sb.append(i).append(' ');
+        }
+        String input = sb.toString();
+        Thread thread = new Thread(() -> {
+            try {
+                Writer writer = pump.getWriter();
+                for (int i = 0; i < input.length(); i += 13) {
+                    writer.write(input, i, Math.min(13, input.length() - i));
+                }
+            } catch (IOException e) {
+                throw new RuntimeException(e);
+            }
+        });
+        thread.start();
+
+        StringBuilder output = new StringBuilder();
+        char[] buf = new char[5];
+        CharBuffer cb = CharBuffer.allocate(11);
+        while (output.length() < input.length()) {
+            if (output.length() % 2 == 0) {
+                int n = pump.read(buf, 0, buf.length);
+                output.append(buf, 0, n);
+            } else {
+                cb.clear();
+                pump.read(cb);
+                cb.flip();
+                output.append(cb);
+            }
+        }
+        thread.join();
+        assertEquals(input, output.toString());
+        pump.close();
+        assertEquals(-1, pump.read());
+    }
+
 }
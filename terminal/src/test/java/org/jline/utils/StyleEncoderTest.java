@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2002-2021, the original author or authors.
+ *
+ * This software is distributable under the BSD license. See the terms of the
+ * BSD license in the documentation provided with this software.
+ *
+ * https://opensource.org/licenses/BSD-3-Clause
+ */
+package org.jline.utils;
+
+import org.jline.utils.AttributedCharSequence.ForceMode;
+import org.junit.Test;
+
+import static org.junit.Assert.assertEquals;
+
+public class StyleEncoderTest {
+
+    private static String encode(AttributedString... strings) {
+        StyleEncoder encoder = new StyleEncoder(256, ForceMode.None, null, null, null);
+        StringBuilder sb = new StringBuilder();
+        for (AttributedString str : strings) {
+            encoder.append(sb, str);
+            sb.append('|');
+        }
+        encoder.reset(sb);
+        return sb.toString();
+    }
+
+    @Test
+    public void testShortestTransition() {
+        AttributedStyle red = AttributedStyle.DEFAULT.bold().underline().foreground(AttributedStyle.RED);
+        AttributedStyle green = AttributedStyle.DEFAULT.foreground(AttributedStyle.GREEN);
+        // resetting is shorter than turning off bold and underline
+        assertEquals("\033[4;31;1ma|\033[0;32mb|\033[0m",
+                encode(new AttributedString("a", red), new AttributedString("b", green)));
+        // changing the color is shorter than resetting
+        assertEquals("\033[4;31;1ma|\033[32;1mb|\033[0m",
+                encode(new AttributedString("a", red), new AttributedString("b", red.foreground(AttributedStyle.GREEN))));
+    }
+
+    @Test
+    public void testStyleKept() {
+        AttributedStyle bold = AttributedStyle.BOLD;
+        assertEquals("\033[1ma|b|\033[0m",
+                encode(new AttributedString("a", bold), new AttributedString("b", bold)));
+    }
+
+    @Test
+    public void testSameRendering() {
+        // both colors are rounded to the same one on a 256 colors terminal
+        AttributedStyle s1 = AttributedStyle.DEFAULT.foregroundRgb(0x5f87af);
+        AttributedStyle s2 = AttributedStyle.DEFAULT.foregroundRgb(0x5f87b0);
+        assertEquals("\033[38;5;67ma|b|\033[0m",
+                encode(new AttributedString("a", s1), new AttributedString("b", s2)));
+    }
+
+}